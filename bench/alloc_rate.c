@@ -0,0 +1,95 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * Allocation rate of a program, to compare the memtracker unwinders.
+ *
+ * The allocations are made "depth" calls deep, so that unwinding costs
+ * what it costs in an application. See mtrace_unwind.sh.
+ *
+ *   alloc_rate [allocations] [depth]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define DEFAULT_ALLOCS  2000000
+#define DEFAULT_DEPTH   8
+#define BATCH           64
+
+static void* volatile sink;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+__attribute__((noinline))
+static void alloc_batch(void)
+{
+    void* ptrs[BATCH];
+    int i;
+
+    for (i = 0; i < BATCH; i++)
+        ptrs[i] = malloc(16 + (i * 24) % 512);
+    sink = ptrs[BATCH - 1];
+    for (i = 0; i < BATCH; i++)
+        free(ptrs[i]);
+}
+
+__attribute__((noinline))
+static void call_deep(int depth, long batches)
+{
+    long i;
+
+    if (depth > 0) {
+        call_deep(depth - 1, batches);
+        __asm__ volatile("" ::: "memory");
+        return;
+    }
+
+    for (i = 0; i < batches; i++)
+        alloc_batch();
+}
+
+int main(int argc, char** argv)
+{
+    long allocs = argc > 1 ? strtol(argv[1], NULL, 10) : DEFAULT_ALLOCS;
+    int depth = argc > 2 ? atoi(argv[2]) : DEFAULT_DEPTH;
+    long batches = allocs / BATCH;
+    uint64_t start, ns;
+
+    if (batches <= 0 || depth < 0) {
+        fprintf(stderr, "Usage: %s [allocations] [depth]\n", argv[0]);
+        return 1;
+    }
+
+    /* Warm up the allocator and the unwinder */
+    call_deep(depth, batches / 10 + 1);
+
+    start = now_ns();
+    call_deep(depth, batches);
+    ns = now_ns() - start;
+
+    printf("%12.0f allocs/sec %8.1f ns/alloc\n",
+        (double)batches * BATCH * 1e9 / ns, (double)ns / (batches * BATCH));
+    return 0;
+}
@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 LG Electronics, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+'''
+Synthetic PmLog file for perflog_scaling.sh.
+
+An IM_KEY_INPUT perflog every millisecond, which opens a session of the
+"App launch time" context of perf-log-viewer-conf.json, a WINDOW_FOCUSIN
+closing them every 5 seconds, and one line in 10 of another program. Each
+start condition sees thousands of open sessions in its 10 s window, which
+an analyzer rescanning the log from each start makes quadratic.
+
+usage: perflog_gen.py LINES [OUTPUT]
+'''
+
+import sys
+
+FOCUS_EVERY = 5000
+NOISE_EVERY = 10
+BUFFERED_LINES = 10000
+
+PERFLOG = '2026-10-17T10:00:00Z [%.3f] user.info sam [1] perflog %s ' \
+    '{"PerfType":"%s","PerfGroup":"%s","CLOCK":%.3f} t\n'
+NOISE = '2026-10-17T10:00:00Z [%.3f] user.info bootd [2] bootd ' \
+    'NOISE {"line":%d} some text\n'
+
+def line(i):
+    clock = 100.0 + i / 1000.0
+    if i % FOCUS_EVERY == FOCUS_EVERY - 1:
+        return PERFLOG % (clock, 'WINDOW_FOCUSIN', 'AppLaunch', 'com.app', clock)
+    if i % NOISE_EVERY == NOISE_EVERY - 1:
+        return NOISE % (clock, i)
+    return PERFLOG % (clock, 'IM_KEY_INPUT', 'Event', 'Input', clock)
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__.strip())
+    lines = int(sys.argv[1])
+    out = open(sys.argv[2], 'w') if len(sys.argv) > 2 else sys.stdout
+    for start in range(0, lines, BUFFERED_LINES):
+        out.write(''.join(line(i) for i in range(start, min(lines, start + BUFFERED_LINES))))
+    out.close()
+
+if __name__ == '__main__':
+    main()
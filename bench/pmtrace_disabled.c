@@ -0,0 +1,125 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * Cost of the PmTrace macros when their events are disabled.
+ *
+ * The macros check the tracepoint state inline, so a disabled call should
+ * cost what a loop with one predicted branch costs, and the arguments
+ * should not be evaluated. "empty" is the loop alone, "branch" the loop
+ * with a branch on a flag read from memory. Run it without a session
+ * tracing pmtrace:* (PMTRACE_RB_SIZE_KB=0 with the ring buffer backend).
+ *
+ *   pmtrace_disabled [iterations]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "PmTrace.h"
+
+#define DEFAULT_ITERATIONS  100000000
+
+static int flag;
+static const int* volatile flag_ptr = &flag;
+static long evaluated;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* An argument the disabled macros must not evaluate */
+__attribute__((noinline))
+static int expensive(long i)
+{
+    evaluated++;
+    return (int)(i * 2654435761U);
+}
+
+static void report(const char* name, long iterations, uint64_t ns, uint64_t base)
+{
+    printf("%-12s %8.3f ns/call %+8.3f ns over empty\n", name,
+        (double)ns / iterations, ((double)ns - (double)base) / iterations);
+}
+
+int main(int argc, char** argv)
+{
+    long iterations = argc > 1 ? strtol(argv[1], NULL, 10) : DEFAULT_ITERATIONS;
+    const int* state = flag_ptr;
+    uint64_t start, base, ns;
+    long i;
+
+    if (iterations <= 0) {
+        fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+    if (*_PmtState_log_kv || *_PmtState_block_entry_kv || *_PmtState_marker_kv) {
+        fprintf(stderr, "The pmtrace events are enabled, stop the session first\n");
+        return 1;
+    }
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++)
+        __asm__ volatile("" ::: "memory");
+    base = now_ns() - start;
+    report("empty", iterations, base, base);
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        __asm__ volatile("" ::: "memory");
+        if (__builtin_expect(*state, 0))
+            expensive(i);
+    }
+    ns = now_ns() - start;
+    report("branch", iterations, ns, base);
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        __asm__ volatile("" ::: "memory");
+        PmtLog("bench", PMTKVD("v", expensive(i)));
+    }
+    ns = now_ns() - start;
+    report("PmtLog", iterations, ns, base);
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        __asm__ volatile("" ::: "memory");
+        PmtBlockEntry("bench", "block", PMTKVD("v", expensive(i)));
+        PmtBlockExit("bench", "block", PMTKVD("v", expensive(i)));
+    }
+    ns = now_ns() - start;
+    report("PmtBlock x2", iterations, ns, base);
+
+    start = now_ns();
+    for (i = 0; i < iterations; i++) {
+        __asm__ volatile("" ::: "memory");
+        PmtMarker("bench", "marker", PMTKVD("v", expensive(i)));
+    }
+    ns = now_ns() - start;
+    report("PmtMarker", iterations, ns, base);
+
+    if (evaluated) {
+        fprintf(stderr, "The arguments were evaluated %ld times\n", evaluated);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * ns/event of the PmTrace events on a tight loop.
+ *
+ * "text" is the path of libPmTrace before the binary payload: the values
+ * are formatted with vsnprintf on the traced thread. "kv" is PmtLog,
+ * which records them as typed fields. Run it while a session traces
+ * pmtrace:* (or with the ring buffer backend) to time the enabled path.
+ *
+ *   pmtrace_event [events]
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "PmTrace.h"
+
+#define DEFAULT_EVENTS  1000000
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void report(const char* name, long events, uint64_t ns)
+{
+    printf("%-6s %10ld events %10.1f ns/event\n", name, events, (double)ns / events);
+}
+
+int main(int argc, char** argv)
+{
+    long events = argc > 1 ? strtol(argv[1], NULL, 10) : DEFAULT_EVENTS;
+    uint64_t start;
+    long i;
+
+    if (events <= 0) {
+        fprintf(stderr, "Usage: %s [events]\n", argv[0]);
+        return 1;
+    }
+
+    if (!*_PmtState_log_kv)
+        fprintf(stderr, "pmtrace:log_kv is disabled, timing the disabled path\n");
+
+    start = now_ns();
+    for (i = 0; i < events; i++)
+        _PmtLog("bench", "{\"id\":%ld, \"name\":\"%s\", \"load\":%f}", i, "event", 0.5);
+    report("text", events, now_ns() - start);
+
+    start = now_ns();
+    for (i = 0; i < events; i++)
+        PmtLog("bench", PMTKVD("id", (int)i), PMTKVS("name", "event"), PMTKVF("load", 0.5));
+    report("kv", events, now_ns() - start);
+
+    return 0;
+}
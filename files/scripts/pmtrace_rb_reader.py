@@ -0,0 +1,281 @@
+#!/usr/bin/env python3
+# Copyright (c) 2026 LG Electronics, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+# http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+# SPDX-License-Identifier: Apache-2.0
+
+'''
+Decode the rings of the libPmTrace ring buffer backend, from a dump file
+(/tmp/pmtrace-<pid>.rb) or from the shared memory segment of a running
+process (/dev/shm/pmtrace-<pid>). The layouts are described in
+src/libpmtrace/PmTraceRingBuffer.h.
+
+Prints one line per event, ordered by time:
+    <monotonic time (s)> <tid> <event> <fields>
+
+The interned categories and names of the _kv events are defined by
+string_def events. A dump has them all; in a live segment, the ones
+overwritten already show as #<id>.
+'''
+
+import argparse
+import glob
+import os
+import re
+import struct
+import sys
+
+MAGIC = 0x52544d50
+VERSION = 1
+
+HEADER = struct.Struct('=IIIIi44x')
+SLOT = struct.Struct('=iIQQ40x')
+RECORD = struct.Struct('=IHHiIQ')
+
+EVENTS = ['padding', 'log', 'block_entry', 'block_exit', 'marker', 'perflog',
+          'log_kv', 'block_entry_kv', 'block_exit_kv', 'marker_kv', 'string_def',
+          'block_complete', 'block_summary', 'perflog_clock', 'payload_oversize']
+STRING_DEF = 10
+
+KV_INT, KV_DOUBLE, KV_STRING = 0, 1, 2
+
+U64_FIELDS = {
+    'block_complete': ('start', 'duration'),
+    'block_summary': ('count', 'total', 'min', 'max', 'p50', 'p99'),
+    'payload_oversize': ('size', 'count'),
+}
+
+CONVERSION = re.compile(r'%([-+ #0-9.*]*)(?:hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGcsp%])')
+
+class Reader(object):
+    def __init__(self, data, pos=0):
+        self.data = data
+        self.pos = pos
+
+    def string(self):
+        end = self.data.index(b'\0', self.pos)
+        s = self.data[self.pos:end].decode('utf-8', 'replace')
+        self.pos = end + 1
+        return s
+
+    def unpack(self, fmt):
+        values = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += struct.calcsize(fmt)
+        return values
+
+    def u32(self):
+        return self.unpack('=I')[0]
+
+    def u64(self):
+        return self.unpack('=Q')[0]
+
+    def seq(self, elem):
+        count = self.u32()
+        return self.unpack('=%d%s' % (count, elem))
+
+    def text(self):
+        count = self.u32()
+        text = self.data[self.pos:self.pos + count]
+        self.pos += count
+        return text
+
+def walk(data, start, tail, head, ring_size, in_place):
+    '''
+    Yield (record header, payload) of the records from "tail" to "head".
+    A record at position "pos" is at data[start + pos % ring_size] when
+    the ring is read in place, else at data[start + pos - tail]. With a
+    ring_size, the tails of the ring too short for a record are skipped.
+    '''
+    pos = tail
+    while pos < head:
+        off = pos % ring_size if ring_size else pos
+        if ring_size and ring_size - off < RECORD.size:
+            pos += ring_size - off
+            continue
+        base = start + (off if in_place else pos - tail)
+        if base + RECORD.size > len(data):
+            return
+        rec = RECORD.unpack_from(data, base)
+        size = rec[0]
+        if size < RECORD.size or size % 8 or pos + size > head:
+            # Overwritten while the segment was read
+            return
+        yield rec, data[base + RECORD.size:base + size]
+        pos += size
+
+def load_dump(data):
+    '''Return (header, [(slot, records)]) of a dump file'''
+    header = HEADER.unpack_from(data, 0)
+    ring_size = header[3]
+    rings = []
+    pos = HEADER.size
+    while pos + SLOT.size <= len(data):
+        slot = SLOT.unpack_from(data, pos)
+        pos += SLOT.size
+        tail, head = slot[2], slot[3]
+        # The string definitions (tid 0) are not a ring: no padding
+        records = walk(data, pos, tail, head, ring_size if slot[0] else 0, False)
+        rings.append((slot, list(records)))
+        pos += head - tail
+    return header, rings
+
+def load_segment(data):
+    '''Return (header, [(slot, records)]) of a live segment'''
+    header = HEADER.unpack_from(data, 0)
+    slot_count, ring_size = header[2], header[3]
+    rings_off = HEADER.size + slot_count * SLOT.size
+    rings = []
+    for i in range(slot_count):
+        slot = SLOT.unpack_from(data, HEADER.size + i * SLOT.size)
+        if slot[0] == 0:
+            continue
+        tail, head = slot[2], slot[3]
+        records = walk(data, rings_off + i * ring_size, tail, head, ring_size, True)
+        rings.append((slot, list(records)))
+    return header, rings
+
+def format_kv(fmt, types, values, text):
+    '''Format the typed values of a _kv event with their printf format'''
+    args = []
+    for t, v in zip(types, values):
+        if t == KV_DOUBLE:
+            args.append(struct.unpack('=d', struct.pack('=q', v))[0])
+        elif t == KV_STRING:
+            end = text.find(b'\0', v)
+            args.append(text[v:end if end >= 0 else len(text)].decode('utf-8', 'replace'))
+        else:
+            args.append(v)
+    if fmt is None:
+        return ' '.join(str(a) for a in args)
+
+    it = iter(args)
+    def convert(m):
+        flags, conv = m.group(1), m.group(2)
+        if conv == '%':
+            return '%'
+        arg = next(it, '')
+        if conv in 'up':
+            conv = 'd' if conv == 'u' else 'x'
+        try:
+            return ('%' + flags + conv) % arg
+        except (TypeError, ValueError):
+            return str(arg)
+    return CONVERSION.sub(convert, fmt)
+
+def decode(name, payload, strings):
+    '''Return the fields of an event as text'''
+    r = Reader(payload)
+    def ref(id):
+        return strings.get(id, '#%d' % id)
+
+    if name == 'log':
+        return 'cat=%s payload=%s' % (r.string(), r.string())
+    if name in ('block_entry', 'block_exit', 'marker', 'perflog'):
+        return 'cat=%s name=%s payload=%s' % (r.string(), r.string(), r.string())
+    if name.endswith('_kv'):
+        cat = ref(r.u32())
+        fields = 'cat=%s ' % cat
+        if name != 'log_kv':
+            fields += 'name=%s ' % ref(r.u32())
+        fmt_id = r.u32()
+        types = r.seq('B')
+        values = r.seq('q')
+        text = r.text()
+        return fields + 'payload=%s' % format_kv(strings.get(fmt_id), types, values, text)
+    if name == 'perflog_clock':
+        ctx, msgid = r.string(), r.string()
+        clock = r.u64()
+        return 'ctx=%s msgid=%s clock=%d payload=%s' % (ctx, msgid, clock, r.string())
+    if name in U64_FIELDS:
+        fields = ''
+        if name != 'payload_oversize':
+            fields = 'cat=%s name=%s ' % (ref(r.u32()), ref(r.u32()))
+        return fields + ' '.join('%s=%d' % (k, r.u64()) for k in U64_FIELDS[name])
+    return ''
+
+def print_events(header, rings, out):
+    strings = {}
+    events = []
+    for slot, records in rings:
+        for rec, payload in records:
+            size, event, _, tid, _, timestamp = rec
+            if event == STRING_DEF:
+                r = Reader(payload)
+                id = r.u32()
+                strings[id] = r.string()
+            elif event != 0 and event < len(EVENTS):
+                events.append((timestamp, tid, EVENTS[event], payload))
+
+    out.write('# pid %d, %d rings of %d bytes\n' % (header[4], header[2], header[3]))
+    for slot, records in rings:
+        if slot[0] != 0:
+            out.write('# thread %d%s: %d events, %d dropped\n'
+                      % (abs(slot[0]), ' (exited)' if slot[0] < 0 else '',
+                         sum(1 for rec, _ in records if rec[1] not in (0, STRING_DEF)),
+                         slot[1]))
+
+    events.sort(key=lambda e: e[0])
+    for timestamp, tid, name, payload in events:
+        try:
+            fields = decode(name, payload, strings)
+        except (ValueError, struct.error):
+            fields = '(truncated)'
+        out.write('%d.%09d %d %s %s\n' % (timestamp // 1000000000, timestamp % 1000000000,
+                                          abs(tid), name, fields))
+
+def clean():
+    '''Remove the segments left by processes that were killed'''
+    for path in glob.glob('/dev/shm/pmtrace-*'):
+        pid = path.rsplit('-', 1)[1]
+        if pid.isdigit() and not os.path.exists('/proc/' + pid):
+            os.unlink(path)
+            print('Removed %s' % path)
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode the libPmTrace ring buffers')
+    parser.add_argument('dump', nargs='?', help='dump file (/tmp/pmtrace-<pid>.rb)')
+    parser.add_argument('-p', '--pid', type=int,
+                        help='read the segment of a running process instead')
+    parser.add_argument('-o', '--output', help='output file (default: stdout)')
+    parser.add_argument('--clean', action='store_true',
+                        help='remove the segments of processes that no longer run')
+    args = parser.parse_args()
+
+    if args.clean:
+        clean()
+        return 0
+    if (args.dump is None) == (args.pid is None):
+        parser.error('give either a dump file or --pid')
+
+    path = args.dump if args.pid is None else '/dev/shm/pmtrace-%d' % args.pid
+    try:
+        with open(path, 'rb') as f:
+            data = f.read()
+    except IOError as e:
+        sys.exit('Cannot read %s: %s' % (path, e))
+
+    if len(data) < HEADER.size or HEADER.unpack_from(data, 0)[0] != MAGIC:
+        sys.exit('%s: not a libPmTrace ring buffer' % path)
+    if HEADER.unpack_from(data, 0)[1] != VERSION:
+        sys.exit('%s: unsupported version %d' % (path, HEADER.unpack_from(data, 0)[1]))
+
+    header, rings = load_dump(data) if args.pid is None else load_segment(data)
+    out = open(args.output, 'w') if args.output else sys.stdout
+    print_events(header, rings, out)
+    if out is not sys.stdout:
+        out.close()
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
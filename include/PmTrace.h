@@ -30,8 +30,11 @@
 #define TRACEPOINT_PROBE_DYNAMIC_LINKAGE
 #endif //PMTRACE_DEFINE
 
+#ifndef PMTRACE_RINGBUFFER
 #include "PmTraceProvider.h"
+#endif
 #include "PmTraceMsg.h"
+#include "PmTraceKv.h"
 
 
 #ifdef __cplusplus
@@ -44,6 +47,24 @@ void _PmtBlockExit(const char* cat, const char* name, const char* fmt, ...);
 void _PmtMarker(const char* cat, const char* name, const char* fmt, ...);
 void _PmtPerfLog(const char* cat, const char* name, const char* fmt, ...);
 
+void _PmtLogKv(const char* cat, const char* fmt, const _PmtKvList* kv);
+void _PmtBlockEntryKv(const char* cat, const char* name, const char* fmt, const _PmtKvList* kv);
+void _PmtBlockExitKv(const char* cat, const char* name, const char* fmt, const _PmtKvList* kv);
+void _PmtMarkerKv(const char* cat, const char* name, const char* fmt, const _PmtKvList* kv);
+void _PmtBlockComplete(const char* cat, const char* name, uint64_t start, uint64_t duration);
+void _PmtPerfLogClock(const char* ctx, const char* msgid, const char* type, const char* group,
+    uint64_t clock, const char* fmt, ...);
+uint64_t _PmtNow(void);
+
+extern uint64_t _PmtBlockMinNs;
+
+extern const int* _PmtState_log_kv;
+extern const int* _PmtState_block_entry_kv;
+extern const int* _PmtState_block_exit_kv;
+extern const int* _PmtState_marker_kv;
+extern const int* _PmtState_block_complete;
+extern const int* _PmtState_perflog;
+
 #ifdef __cplusplus
 }
 #endif
@@ -57,11 +78,90 @@ void _PmtPerfLog(const char* cat, const char* name, const char* fmt, ...);
  * PMTKVS : for string
  * PMTKVD : for integer
  * PMTKVF : for float
+ *
+ * PmtLog, PmtBlockEntry/Exit and PmtMarker record the values as a binary
+ * payload (see PmTraceKv.h), so no formatting is done on the traced thread.
  */
 #define PMTKVS(k, v)    k, "%s", v
 #define PMTKVD(k, v)    k, %d, v
 #define PMTKVF(k, v)    k, %f, v
 
+/**
+ * @brief Check whether a tracepoint of libPmTrace is enabled.
+ *
+ * It reads the tracepoint state LTTng updates on enablement, so the
+ * macros below skip argument evaluation and the call into libPmTrace
+ * with a single predicted branch when no session traces the event.
+ * If libPmTrace was built against an lttng-ust whose tracepoint layout
+ * it does not know, the state is always set and libPmTrace checks.
+ */
+#define _PMT_ENABLED(event) \
+    __builtin_expect(*_PmtState_##event, 0)
+
+#define _PMT_EXPAND(...) __VA_ARGS__
+
+#if defined(__cplusplus) && __cplusplus >= 201103L
+
+/**
+ * @brief C++ front end of the binary payload.
+ *
+ * The types of the values are deduced at compile time and the record is
+ * built in place, so there is no va_list, no format parsing and no
+ * per-value dispatch. FORMATTED_VA supplies the format and the values.
+ */
+#define _PMT_KV_RECORD(kv, Args, args) \
+    static_assert(sizeof...(Args) <= PMT_KV_MAX, "Too many argument macros"); \
+    const _PmtKvList kv = { sizeof...(Args), \
+        { _PmtKvType<Args>::tag... }, { _PmtKvType<Args>::bits(args)... } }
+
+template<typename... Args>
+inline void _PmtLogT(const char* cat, const char* fmt, Args... args)
+{
+    _PMT_KV_RECORD(kv, Args, args);
+    _PmtLogKv(cat, fmt, &kv);
+}
+
+template<typename... Args>
+inline void _PmtBlockEntryT(const char* cat, const char* name, const char* fmt, Args... args)
+{
+    _PMT_KV_RECORD(kv, Args, args);
+    _PmtBlockEntryKv(cat, name, fmt, &kv);
+}
+
+template<typename... Args>
+inline void _PmtBlockExitT(const char* cat, const char* name, const char* fmt, Args... args)
+{
+    _PMT_KV_RECORD(kv, Args, args);
+    _PmtBlockExitKv(cat, name, fmt, &kv);
+}
+
+template<typename... Args>
+inline void _PmtMarkerT(const char* cat, const char* name, const char* fmt, Args... args)
+{
+    _PMT_KV_RECORD(kv, Args, args);
+    _PmtMarkerKv(cat, name, fmt, &kv);
+}
+
+#define _PMT_KV_CALL(func, event, args, ...) \
+    do { \
+        if (_PMT_ENABLED(event)) \
+            func##T(_PMT_EXPAND args, FORMATTED_VA(__VA_ARGS__)); \
+    } while(0)
+
+#else // __cplusplus >= 201103L
+
+#define _PMT_KV_CALL(func, event, args, ...) \
+    do { \
+        if (_PMT_ENABLED(event)) { \
+            _PmtKvList _pmtKv; \
+            _pmtKv.count = 0; \
+            FORMATTED_KV(&_pmtKv, __VA_ARGS__) \
+            func##Kv(_PMT_EXPAND args, FORMATTED_FMT(__VA_ARGS__), &_pmtKv); \
+        } \
+    } while(0)
+
+#endif // __cplusplus >= 201103L
+
 /**
  * @brief PmLog is for free form tracing.
  *
@@ -69,7 +169,7 @@ void _PmtPerfLog(const char* cat, const char* name, const char* fmt, ...);
  * @param ... A payload for argument macros (up to 10).
  */
 #define PmtLog(cat, ...) \
-    _PmtLog(cat, FORMATTED_VA(__VA_ARGS__))
+    _PMT_KV_CALL(_PmtLog, log_kv, (cat), __VA_ARGS__)
 
 /**
  * @brief PmtBlockEntry is for tracing the duration of a scope.
@@ -80,7 +180,7 @@ void _PmtPerfLog(const char* cat, const char* name, const char* fmt, ...);
  * @param ... A payload for argument macros (up to 10).
  */
 #define PmtBlockEntry(cat, name, ...) \
-    _PmtBlockEntry(cat, name, FORMATTED_VA(__VA_ARGS__))
+    _PMT_KV_CALL(_PmtBlockEntry, block_entry_kv, (cat, name), __VA_ARGS__)
 
 /**
  * @brief PmtBlockExit is for tracing the duration of a scope.
@@ -91,7 +191,7 @@ void _PmtPerfLog(const char* cat, const char* name, const char* fmt, ...);
  * @param ... A payload for argument macros (up to 10).
  */
 #define PmtBlockExit(cat, name, ...) \
-    _PmtBlockExit(cat, name, FORMATTED_VA(__VA_ARGS__))
+    _PMT_KV_CALL(_PmtBlockExit, block_exit_kv, (cat, name), __VA_ARGS__)
 
 /**
  * @brief PmtMarker is for an important note.
@@ -101,26 +201,34 @@ void _PmtPerfLog(const char* cat, const char* name, const char* fmt, ...);
  * @param ... A payload for argument macros (up to 10).
  */
 #define PmtMarker(cat, name, ...) \
-    _PmtMarker(cat, name, FORMATTED_VA(__VA_ARGS__))
+    _PMT_KV_CALL(_PmtMarker, marker_kv, (cat, name), __VA_ARGS__)
 
 #ifdef __cplusplus
 
 class _PmtScopedBlock {
 public:
-    _PmtScopedBlock(const char* cat, const char* name)
-        : blkCat(cat), blkName(name)
+    _PmtScopedBlock(const char* cat, const char* name, uint64_t minNs = 0)
+        : blkCat(cat), blkName(name), blkMinNs(minNs), blkStart(0)
     {
-        _PmtBlockEntry(blkCat, blkName, const_cast<char*>(""));
+        if (_PMT_ENABLED(block_complete))
+            blkStart = _PmtNow();
     }
 
     ~_PmtScopedBlock()
     {
-        _PmtBlockExit(blkCat, blkName, const_cast<char*>(""));
+        if (blkStart && _PMT_ENABLED(block_complete)) {
+            uint64_t duration = _PmtNow() - blkStart;
+
+            if (duration >= blkMinNs && duration >= _PmtBlockMinNs)
+                _PmtBlockComplete(blkCat, blkName, blkStart, duration);
+        }
     }
 
 private:
     const char* blkCat;
     const char* blkName;
+    uint64_t blkMinNs;
+    uint64_t blkStart;
 
     // Prevent heap allocation
     void operator delete(void*);
@@ -132,7 +240,11 @@ private:
 /**
  * @brief PmtScopedBlock is for tracing the duration of a block.
  *        Declare this on the head or block and then
- *        it will insert PmtBlockEntry/Exit automatically.
+ *        it will record a block_complete event with the start time
+ *        and the duration of the block when it goes out of scope.
+ *
+ * Blocks shorter than PMTRACE_BLOCK_MIN_US microseconds (environment
+ * variable, default 0) are not recorded.
  *
  * Note that it's supported only in C++, not in C. In C code use
  * PmtBlockEntry/Exit pair manually at both ends of a block.
@@ -142,13 +254,22 @@ private:
 #define PmtScopedBlock(cat) \
     _PmtScopedBlock traceScopedBlock(cat, __PRETTY_FUNCTION__)
 
+/**
+ * @brief PmtScopedBlockMin is PmtScopedBlock which drops blocks
+ *        shorter than a given duration.
+ *
+ * @param cat A category for tracing.
+ * @param minUs A minimum duration to record in microseconds.
+ */
+#define PmtScopedBlockMin(cat, minUs) \
+    _PmtScopedBlock traceScopedBlock(cat, __PRETTY_FUNCTION__, (uint64_t)(minUs) * 1000)
+
 #endif // __cplusplus
 
 /**
  * @brief PmtPerfLog is for post-processable event from PmDaemon.
  */
 #ifdef PERFLOG_USE_PMLOG
-#include <time.h>
 #include <PmLogLib.h>
 
 #define _PmLogMsgPerfLog(x) __PmLogMsgPerfLog##x
@@ -164,48 +285,36 @@ private:
 
 #define PmtPerfLog(ctx, msgid, type, group, kv_count, ...) \
     do { \
-        struct timespec ts; \
-        clock_gettime(CLOCK_MONOTONIC, &ts); \
+        uint64_t now = _PmtNow(); \
+        intmax_t sec = (intmax_t) (now / 1000000000); \
+        int msec = (int) (now % 1000000000 / 1000000); \
         _PmLogMsgPerfLog(kv_count)(ctx, Info, msgid, \
-            "CLOCK", "%jd.%03d", (intmax_t) ts.tv_sec, ts.tv_nsec / 1000000, \
+            "CLOCK", "%jd.%03d", sec, msec, \
             "PerfType", "\"%s\"", type, \
             "PerfGroup", "\"%s\"", group, \
             __VA_ARGS__); \
-        if (tracepoint_enabled(pmtrace, perflog)) { \
-            char payload[128]; \
-            snprintf(payload, 128, "{\"CLOCK\":%jd.%03d, \"PerfType\":\"%s\", \"PerfGroup\":\"%s\"}", (intmax_t) ts.tv_sec, ts.tv_nsec / 1000000, type, group); \
-            do_tracepoint(pmtrace, perflog, "perflog", msgid, payload); \
-        } \
+        if (_PMT_ENABLED(perflog)) \
+            _PmtPerfLog("perflog", msgid, "{\"CLOCK\":%jd.%03d, \"PerfType\":\"%s\", \"PerfGroup\":\"%s\"}", sec, msec, type, group); \
     } while(0)
 
 #else // PERFLOG_USE_PMLOG
 
-#include <time.h>
-#include <syslog.h>
-
-#define _PmtPerfLogSyslog(...) \
-    syslog(LOG_INFO, FORMATTED_VA(__VA_ARGS__))
-#define _PmtPerfLogLttng(cat, name, ...) \
-    _PmtPerfLog(cat, name, FORMATTED_VA(__VA_ARGS__))
-#define CLOCK_STR_LEN 128
-
+/**
+ * @brief Performance log to syslog and the perflog_clock event.
+ *
+ * The message is formatted once by libPmTrace and written to syslog
+ * by a background thread, so the caller does not block on /dev/log.
+ */
 #define PmtPerfLog(ctx, msgid, type, group, ...) \
-    do { \
-        struct timespec ts; \
-        char clk[CLOCK_STR_LEN]; \
-        clock_gettime(CLOCK_MONOTONIC, &ts); \
-        snprintf(clk, CLOCK_STR_LEN, "%jd.%3d", (intmax_t) ts.tv_sec, ts.tv_nsec / 1000000); \
-        _PmtPerfLogSyslog(PMTKVS("ctx", ctx), PMTKVS("CLOCK", clk), PMTKVS("msgid", msgid), PMTKVS("PerfType", type), PMTKVS("PerfGroup", group), __VA_ARGS__); \
-        _PmtPerfLogLttng(ctx, msgid, PMTKVS("CLOCK", clk), PMTKVS("PerfType", type), PMTKVS("PerfGroup", group), __VA_ARGS__); \
-    } while(0)
+    _PmtPerfLogClock(ctx, msgid, type, group, _PmtNow(), FORMATTED_VA(__VA_ARGS__))
 
 #endif
 
 /* TODO: Remove below macros which are for backward compatibility */
 #define PMTRACE_BEFORE(name) \
-    tracepoint(pmtrace, block_entry, "UNKNOWN", name, "")
+    _PmtBlockEntry("UNKNOWN", name, "")
 #define PMTRACE_AFTER(name) \
-    tracepoint(pmtrace, block_exit, "UNKNOWN", name, "")
+    _PmtBlockExit("UNKNOWN", name, "")
 
 #else // ENABLE_PMTRACE
 
@@ -214,6 +323,7 @@ private:
 #define PmtBlockExit(cat, name, ...) do {} while(0)
 #define PmtMarker(cat, name, ...) do {} while(0)
 #define PmtScopedBlock(cat) do {} while(0)
+#define PmtScopedBlockMin(cat, minUs) do {} while(0)
 #define PmtPerfLog(ctx, msgid, type, group, ...) do {} while(0)
 
 /* TODO: Remove below macros which are for backward compatibility */
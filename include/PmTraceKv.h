@@ -0,0 +1,129 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PMTRACE_KV_H
+#define __PMTRACE_KV_H
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Binary key/value payload
+ *
+ * The argument macros (PMTKVS/PMTKVD/PMTKVF) are recorded as typed values
+ * instead of being formatted into a JSON string on the traced thread.
+ * The format string built by FORMATTED_VA is recorded along with them,
+ * so the original payload can be rebuilt offline at read time.
+ *
+ * Strings are carried as references. libPmTrace copies them into the
+ * event only when the tracepoint is enabled.
+ */
+#define PMT_KV_MAX      10
+
+#define PMT_KV_INT      0
+#define PMT_KV_DOUBLE   1
+#define PMT_KV_STRING   2
+
+typedef struct _PmtKvList {
+    unsigned int count;
+    unsigned char types[PMT_KV_MAX];
+    int64_t values[PMT_KV_MAX];
+} _PmtKvList;
+
+static inline int64_t _PmtKvDoubleBits(double v)
+{
+    int64_t bits;
+
+    memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+static inline void _PmtKvPutInt(_PmtKvList* kv, int64_t v)
+{
+    kv->types[kv->count] = PMT_KV_INT;
+    kv->values[kv->count++] = v;
+}
+
+static inline void _PmtKvPutDouble(_PmtKvList* kv, double v)
+{
+    kv->types[kv->count] = PMT_KV_DOUBLE;
+    kv->values[kv->count++] = _PmtKvDoubleBits(v);
+}
+
+static inline void _PmtKvPutStr(_PmtKvList* kv, const char* v)
+{
+    kv->types[kv->count] = PMT_KV_STRING;
+    kv->values[kv->count++] = (int64_t)(intptr_t)v;
+}
+
+#ifdef __cplusplus
+
+/**
+ * @brief Type of a value, resolved at compile time.
+ */
+template<typename T> struct _PmtKvType {
+    static const unsigned char tag = PMT_KV_INT;
+    static int64_t bits(T v) { return (int64_t)v; }
+};
+
+template<> struct _PmtKvType<float> {
+    static const unsigned char tag = PMT_KV_DOUBLE;
+    static int64_t bits(float v) { return _PmtKvDoubleBits(v); }
+};
+
+template<> struct _PmtKvType<double> {
+    static const unsigned char tag = PMT_KV_DOUBLE;
+    static int64_t bits(double v) { return _PmtKvDoubleBits(v); }
+};
+
+template<> struct _PmtKvType<long double> {
+    static const unsigned char tag = PMT_KV_DOUBLE;
+    static int64_t bits(long double v) { return _PmtKvDoubleBits((double)v); }
+};
+
+template<> struct _PmtKvType<char*> {
+    static const unsigned char tag = PMT_KV_STRING;
+    static int64_t bits(const char* v) { return (int64_t)(intptr_t)v; }
+};
+
+template<> struct _PmtKvType<const char*> {
+    static const unsigned char tag = PMT_KV_STRING;
+    static int64_t bits(const char* v) { return (int64_t)(intptr_t)v; }
+};
+
+template<typename T>
+static inline void _PmtKvPut(_PmtKvList* kv, T v)
+{
+    kv->types[kv->count] = _PmtKvType<T>::tag;
+    kv->values[kv->count++] = _PmtKvType<T>::bits(v);
+}
+
+#define _PMT_KV_PUT(kv, v) _PmtKvPut(kv, v)
+
+#else // __cplusplus
+
+#define _PMT_KV_PUT(kv, v) \
+    _Generic((v), \
+        char*: _PmtKvPutStr, \
+        const char*: _PmtKvPutStr, \
+        float: _PmtKvPutDouble, \
+        double: _PmtKvPutDouble, \
+        long double: _PmtKvPutDouble, \
+        default: _PmtKvPutInt)(kv, v)
+
+#endif // __cplusplus
+
+#endif // __PMTRACE_KV_H
@@ -114,3 +114,64 @@
  */
 #define FORMATTED_VA(...) \
     _MCRCAT(_KVS, __VA_NARG__(__VA_ARGS__))(__VA_ARGS__)
+
+/**
+ * @brief Collect the values of argument macros into a _PmtKvList.
+ *
+ * Counterpart of "_KVS##" which keeps the values typed instead of
+ * passing them to a varargs function.
+ */
+#define _KVA1(kv, ...)
+#define _KVA3(kv, k1, f1, v1) \
+    _PMT_KV_PUT(kv, v1);
+#define _KVA6(kv, k1, f1, v1, k2, f2, v2) \
+    _KVA3(kv, k1, f1, v1) _PMT_KV_PUT(kv, v2);
+#define _KVA7(kv, k1, f1, v1, k2, f2, v2, ...) \
+    _KVA6(kv, k1, f1, v1, k2, f2, v2)
+#define _KVA9(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3) \
+    _KVA6(kv, k1, f1, v1, k2, f2, v2) _PMT_KV_PUT(kv, v3);
+#define _KVA10(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, ...) \
+    _KVA9(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3)
+#define _KVA12(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4) \
+    _KVA9(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3) _PMT_KV_PUT(kv, v4);
+#define _KVA13(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, ...) \
+    _KVA12(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4)
+#define _KVA15(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5) \
+    _KVA12(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4) _PMT_KV_PUT(kv, v5);
+#define _KVA16(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, ...) \
+    _KVA15(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5)
+#define _KVA18(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, \
+    k6, f6, v6) \
+    _KVA15(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5) \
+    _PMT_KV_PUT(kv, v6);
+#define _KVA21(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, \
+    k6, f6, v6, k7, f7, v7) \
+    _KVA18(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, \
+    k6, f6, v6) _PMT_KV_PUT(kv, v7);
+#define _KVA24(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, \
+    k6, f6, v6, k7, f7, v7, k8, f8, v8) \
+    _KVA21(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, \
+    k6, f6, v6, k7, f7, v7) _PMT_KV_PUT(kv, v8);
+#define _KVA27(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, \
+    k6, f6, v6, k7, f7, v7, k8, f8, v8, k9, f9, v9) \
+    _KVA24(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, \
+    k6, f6, v6, k7, f7, v7, k8, f8, v8) _PMT_KV_PUT(kv, v9);
+#define _KVA30(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, \
+    k6, f6, v6, k7, f7, v7, k8, f8, v8, k9, f9, v9, k10, f10, v10) \
+    _KVA27(kv, k1, f1, v1, k2, f2, v2, k3, f3, v3, k4, f4, v4, k5, f5, v5, \
+    k6, f6, v6, k7, f7, v7, k8, f8, v8, k9, f9, v9) _PMT_KV_PUT(kv, v10);
+
+/**
+ * @brief Handle variadic variable for the binary payload.
+ *
+ * FORMATTED_KV appends the values of argument macros to "kv" and
+ * FORMATTED_FMT is the format string FORMATTED_VA would have produced,
+ * without evaluating the values.
+ */
+#define FORMATTED_KV(kv, ...) \
+    _MCRCAT(_KVA, __VA_NARG__(__VA_ARGS__))(kv, __VA_ARGS__)
+
+#define __FIRST_ARG(first, ...) first
+#define _FIRST_ARG(...) __FIRST_ARG(__VA_ARGS__, )
+#define FORMATTED_FMT(...) \
+    _FIRST_ARG(FORMATTED_VA(__VA_ARGS__))
@@ -61,6 +61,171 @@ TRACEPOINT_EVENT_CLASS(
     )
 )
 
+/*
+    Interned strings.
+    Categories, names and formats are recorded once by "string_def" and
+    referred by their IDs afterwards.
+*/
+
+TRACEPOINT_EVENT_CLASS(
+    pmtrace,
+    cls_id_string,
+    TP_ARGS(
+        uint32_t, id,
+        char*, str
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, id, id)
+        ctf_string(str, str)
+    )
+)
+
+/*
+    Binary key/value payload.
+    "fmt_id" is the format string of the argument macros, "types" and
+    "values" are the typed values and "text" holds the NUL-terminated
+    strings which are referred by their offsets in "values".
+*/
+
+TRACEPOINT_EVENT_CLASS(
+    pmtrace,
+    cls_kv,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, fmt_id,
+        const unsigned char*, types,
+        const int64_t*, values,
+        unsigned int, count,
+        const char*, text,
+        size_t, text_len
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, cat_id, cat_id)
+        ctf_integer(uint32_t, fmt_id, fmt_id)
+        ctf_sequence(unsigned char, types, types, unsigned int, count)
+        ctf_sequence(int64_t, values, values, unsigned int, count)
+        ctf_sequence_text(char, text, text, size_t, text_len)
+    )
+)
+
+TRACEPOINT_EVENT_CLASS(
+    pmtrace,
+    cls_name_kv,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, name_id,
+        uint32_t, fmt_id,
+        const unsigned char*, types,
+        const int64_t*, values,
+        unsigned int, count,
+        const char*, text,
+        size_t, text_len
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, cat_id, cat_id)
+        ctf_integer(uint32_t, name_id, name_id)
+        ctf_integer(uint32_t, fmt_id, fmt_id)
+        ctf_sequence(unsigned char, types, types, unsigned int, count)
+        ctf_sequence(int64_t, values, values, unsigned int, count)
+        ctf_sequence_text(char, text, text, size_t, text_len)
+    )
+)
+
+/*
+    Duration of a scoped block.
+    "start" and "duration" are CLOCK_MONOTONIC nanoseconds.
+*/
+
+TRACEPOINT_EVENT_CLASS(
+    pmtrace,
+    cls_duration,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, name_id,
+        uint64_t, start,
+        uint64_t, duration
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, cat_id, cat_id)
+        ctf_integer(uint32_t, name_id, name_id)
+        ctf_integer(uint64_t, start, start)
+        ctf_integer(uint64_t, duration, duration)
+    )
+)
+
+/*
+    Latency summary of a block in the aggregation mode of libPmTrace.
+    Durations are in nanoseconds. The blocks which had no room in the
+    histograms are counted in a summary of "pmtrace" and "(overflow)",
+    whose other fields are 0.
+*/
+
+TRACEPOINT_EVENT_CLASS(
+    pmtrace,
+    cls_summary,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, name_id,
+        uint64_t, count,
+        uint64_t, total,
+        uint64_t, min,
+        uint64_t, max,
+        uint64_t, p50,
+        uint64_t, p99
+    ),
+    TP_FIELDS(
+        ctf_integer(uint32_t, cat_id, cat_id)
+        ctf_integer(uint32_t, name_id, name_id)
+        ctf_integer(uint64_t, count, count)
+        ctf_integer(uint64_t, total, total)
+        ctf_integer(uint64_t, min, min)
+        ctf_integer(uint64_t, max, max)
+        ctf_integer(uint64_t, p50, p50)
+        ctf_integer(uint64_t, p99, p99)
+    )
+)
+
+/*
+    PmtPerfLog message.
+    "clock" is CLOCK_MONOTONIC nanoseconds, and "payload" is the JSON
+    message written to syslog.
+*/
+
+TRACEPOINT_EVENT_CLASS(
+    pmtrace,
+    cls_perflog,
+    TP_ARGS(
+        char*, ctx,
+        char*, msgid,
+        uint64_t, clock,
+        char*, payload
+    ),
+    TP_FIELDS(
+        ctf_string(ctx, ctx)
+        ctf_string(msgid, msgid)
+        ctf_integer(uint64_t, clock, clock)
+        ctf_string(payload, payload)
+    )
+)
+
+/*
+    Payloads longer than the 128 bytes libPmTrace used to truncate them to.
+    "count" is the number of such payloads so far.
+*/
+
+TRACEPOINT_EVENT_CLASS(
+    pmtrace,
+    cls_oversize,
+    TP_ARGS(
+        uint64_t, size,
+        uint64_t, count
+    ),
+    TP_FIELDS(
+        ctf_integer(uint64_t, size, size)
+        ctf_integer(uint64_t, count, count)
+    )
+)
+
 /*
     Tracepoint instances
 */
@@ -119,6 +284,129 @@ TRACEPOINT_EVENT_INSTANCE(
     )
 )
 
+TRACEPOINT_EVENT_INSTANCE(
+    pmtrace,
+    cls_name_kv,
+    block_entry_kv,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, name_id,
+        uint32_t, fmt_id,
+        const unsigned char*, types,
+        const int64_t*, values,
+        unsigned int, count,
+        const char*, text,
+        size_t, text_len
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    pmtrace,
+    cls_name_kv,
+    block_exit_kv,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, name_id,
+        uint32_t, fmt_id,
+        const unsigned char*, types,
+        const int64_t*, values,
+        unsigned int, count,
+        const char*, text,
+        size_t, text_len
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    pmtrace,
+    cls_kv,
+    log_kv,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, fmt_id,
+        const unsigned char*, types,
+        const int64_t*, values,
+        unsigned int, count,
+        const char*, text,
+        size_t, text_len
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    pmtrace,
+    cls_name_kv,
+    marker_kv,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, name_id,
+        uint32_t, fmt_id,
+        const unsigned char*, types,
+        const int64_t*, values,
+        unsigned int, count,
+        const char*, text,
+        size_t, text_len
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    pmtrace,
+    cls_id_string,
+    string_def,
+    TP_ARGS(
+        uint32_t, id,
+        char*, str
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    pmtrace,
+    cls_duration,
+    block_complete,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, name_id,
+        uint64_t, start,
+        uint64_t, duration
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    pmtrace,
+    cls_summary,
+    block_summary,
+    TP_ARGS(
+        uint32_t, cat_id,
+        uint32_t, name_id,
+        uint64_t, count,
+        uint64_t, total,
+        uint64_t, min,
+        uint64_t, max,
+        uint64_t, p50,
+        uint64_t, p99
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    pmtrace,
+    cls_perflog,
+    perflog_clock,
+    TP_ARGS(
+        char*, ctx,
+        char*, msgid,
+        uint64_t, clock,
+        char*, payload
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+    pmtrace,
+    cls_oversize,
+    payload_oversize,
+    TP_ARGS(
+        uint64_t, size,
+        uint64_t, count
+    )
+)
+
 #endif /* __PMTRACE_PROVIDER_H */
 
 #include <lttng/tracepoint-event.h>
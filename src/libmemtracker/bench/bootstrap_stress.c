@@ -0,0 +1,311 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * Allocations from many threads at load time, to stress the bootstrap
+ * arena of the malloc wrapper.
+ *
+ * Preloaded after the wrapper, its constructor holds the wrapper in the
+ * state of a symbol resolution with mtrace_bootstrap_hold(), and starts
+ * the threads. Their first allocations come from the static allocator,
+ * until the last thread done with them releases the hold; the blocks are
+ * then reallocated and freed through IS_BOOTSTRAP like the others. The
+ * blocks are checked for overlaps (by their fill pattern),
+ * alignment and zeroing. The destructor joins the threads, prints the
+ * number of blocks seen from the bootstrap arena and the span of their
+ * addresses, and exits with 1 on an error, if no block came from the
+ * arena or if the arena did not grow past its first chunk. See
+ * bootstrap_stress.sh.
+ *
+ *   STRESS_THREADS      threads to start (default 32)
+ *   STRESS_ITERATIONS   allocations per thread (default 10000)
+ *   STRESS_HOLD         allocations per thread while held (default 100)
+ */
+
+#define _GNU_SOURCE
+
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <malloc.h>
+
+#define DEFAULT_THREADS 32
+#define DEFAULT_ITERATIONS 10000
+#define DEFAULT_HOLD 100
+#define MAX_THREADS 256
+#define LIVE_BLOCKS 32
+#define MAX_BLOCK_SIZE (64 << 10)
+
+/* BOOTSTRAP_CHUNK of the wrapper, by which the arena grows */
+#define BOOTSTRAP_CHUNK (64UL << 10)
+
+struct block {
+    unsigned char *ptr;
+    size_t size;
+    unsigned char fill;
+};
+
+static pthread_t threads[MAX_THREADS];
+static int nthreads;
+static long iterations;
+static long hold_iterations;
+static int start;
+static int threads_held;
+static int released;
+static unsigned long errors;
+static unsigned long bootstrap_blocks;
+static uintptr_t bootstrap_low = UINTPTR_MAX;
+static uintptr_t bootstrap_high;
+
+static void (*bootstrap_hold)(int hold);
+
+static
+void report(const char *what, int id, long i)
+{
+    __atomic_add_fetch(&errors, 1, __ATOMIC_RELAXED);
+    fprintf(stderr, "bootstrap_stress: thread %d, iteration %ld: %s\n",
+        id, i, what);
+}
+
+/*
+ * The static allocator keeps the requested size before each block, where
+ * glibc keeps the size of the chunk, which is always larger.
+ */
+static
+void count_bootstrap(const struct block *b)
+{
+    uintptr_t low = (uintptr_t)b->ptr;
+    uintptr_t high = low + b->size;
+    uintptr_t cur;
+
+    if (((const size_t *)b->ptr)[-1] != b->size)
+        return;
+    __atomic_add_fetch(&bootstrap_blocks, 1, __ATOMIC_RELAXED);
+
+    cur = __atomic_load_n(&bootstrap_low, __ATOMIC_RELAXED);
+    while (low < cur && !__atomic_compare_exchange_n(&bootstrap_low, &cur,
+            low, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+    cur = __atomic_load_n(&bootstrap_high, __ATOMIC_RELAXED);
+    while (high > cur && !__atomic_compare_exchange_n(&bootstrap_high, &cur,
+            high, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static
+int check_fill(const struct block *b)
+{
+    size_t i;
+
+    for (i = 0; i < b->size; i++)
+        if (b->ptr[i] != b->fill)
+            return 0;
+    return 1;
+}
+
+/* Allocate with one of the wrapped functions, chosen by "i" */
+static
+int alloc_block(struct block *b, int id, long i, unsigned int rnd)
+{
+    size_t align = (size_t)16 << (rnd % 4);
+
+    b->size = 1 + rnd % 2048;
+    b->fill = (unsigned char)(id * 31 + i);
+
+    switch (i % 4) {
+    case 0:
+        b->ptr = malloc(b->size);
+        break;
+    case 1: {
+        size_t j;
+
+        b->ptr = calloc(1, b->size);
+        for (j = 0; b->ptr && j < b->size; j++)
+            if (b->ptr[j]) {
+                report("calloc block not zeroed", id, i);
+                break;
+            }
+        break;
+    }
+    case 2:
+        b->ptr = memalign(align, b->size);
+        if (b->ptr && (uintptr_t)b->ptr % align)
+            report("memalign block misaligned", id, i);
+        break;
+    default:
+        if (posix_memalign((void **)&b->ptr, align, b->size))
+            b->ptr = NULL;
+        else if ((uintptr_t)b->ptr % align)
+            report("posix_memalign block misaligned", id, i);
+        break;
+    }
+    if (!b->ptr) {
+        report("allocation failed", id, i);
+        return 0;
+    }
+    count_bootstrap(b);
+    memset(b->ptr, b->fill, b->size);
+    return 1;
+}
+
+/* Grow a block, which must keep its contents */
+static
+int grow_block(struct block *b, int id, long i)
+{
+    size_t old_size = b->size;
+    unsigned char *ptr = realloc(b->ptr, old_size * 2);
+    size_t j;
+
+    if (!ptr) {
+        report("realloc failed", id, i);
+        return 0;
+    }
+    for (j = 0; j < old_size; j++)
+        if (ptr[j] != b->fill) {
+            report("realloc lost the contents", id, i);
+            break;
+        }
+    b->ptr = ptr;
+    b->size = old_size * 2;
+    count_bootstrap(b);
+    memset(b->ptr, b->fill, b->size);
+    return 1;
+}
+
+static
+void *stress_thread(void *arg)
+{
+    struct block live[LIVE_BLOCKS];
+    int id = (int)(intptr_t)arg;
+    unsigned int rnd = id + 1;
+    long i;
+    int n;
+
+    /* Start together, to allocate while the symbols are resolved */
+    while (!__atomic_load_n(&start, __ATOMIC_ACQUIRE))
+        sched_yield();
+
+    memset(live, 0, sizeof(live));
+    for (i = 0; i < iterations; i++) {
+        struct block *b = &live[i % LIVE_BLOCKS];
+
+        /*
+         * Wait for the others at the end of the held allocations, for
+         * the arena to stay small. The last thread releases.
+         */
+        if (i == hold_iterations) {
+            if (__atomic_add_fetch(&threads_held, 1, __ATOMIC_ACQ_REL) == nthreads) {
+                bootstrap_hold(0);
+                __atomic_store_n(&released, 1, __ATOMIC_RELEASE);
+            }
+            while (!__atomic_load_n(&released, __ATOMIC_ACQUIRE))
+                sched_yield();
+        }
+
+        rnd = rnd * 1103515245 + 12345;
+        if (b->ptr) {
+            if (!check_fill(b))
+                report("block overwritten", id, i);
+            if ((rnd & 0x10000) || b->size > MAX_BLOCK_SIZE) {
+                free(b->ptr);
+                b->ptr = NULL;
+            } else if (!grow_block(b, id, i)) {
+                continue;
+            }
+        }
+        if (!b->ptr && !alloc_block(b, id, i, rnd >> 8))
+            continue;
+    }
+
+    for (n = 0; n < LIVE_BLOCKS; n++) {
+        if (!live[n].ptr)
+            continue;
+        if (!check_fill(&live[n]))
+            report("block overwritten", id, i);
+        free(live[n].ptr);
+    }
+    return NULL;
+}
+
+static
+long env_long(const char *name, long def)
+{
+    const char *env = getenv(name);
+
+    return env && atol(env) > 0 ? atol(env) : def;
+}
+
+__attribute__((constructor(101)))
+static
+void stress_init(void)
+{
+    int i;
+
+    nthreads = (int)env_long("STRESS_THREADS", DEFAULT_THREADS);
+    if (nthreads > MAX_THREADS)
+        nthreads = MAX_THREADS;
+    iterations = env_long("STRESS_ITERATIONS", DEFAULT_ITERATIONS);
+    hold_iterations = env_long("STRESS_HOLD", DEFAULT_HOLD);
+    if (hold_iterations >= iterations)
+        hold_iterations = iterations - 1;
+
+    *(void **)&bootstrap_hold = dlsym(RTLD_DEFAULT, "mtrace_bootstrap_hold");
+    if (!bootstrap_hold) {
+        fprintf(stderr, "bootstrap_stress: no memtracker wrapper preloaded\n");
+        _exit(1);
+    }
+    bootstrap_hold(1);
+
+    for (i = 0; i < nthreads; i++) {
+        if (pthread_create(&threads[i], NULL, stress_thread,
+                (void *)(intptr_t)i) != 0) {
+            fprintf(stderr, "bootstrap_stress: cannot start thread %d\n", i);
+            _exit(1);
+        }
+    }
+    __atomic_store_n(&start, 1, __ATOMIC_RELEASE);
+}
+
+__attribute__((destructor))
+static
+void stress_fini(void)
+{
+    int i;
+
+    for (i = 0; i < nthreads; i++)
+        pthread_join(threads[i], NULL);
+
+    if (bootstrap_blocks == 0) {
+        fprintf(stderr, "bootstrap_stress: no block from the bootstrap arena\n");
+        errors++;
+    } else if (bootstrap_high - bootstrap_low <= BOOTSTRAP_CHUNK) {
+        fprintf(stderr, "bootstrap_stress: the bootstrap arena did not grow\n");
+        errors++;
+    }
+
+    fprintf(stderr, "bootstrap_stress: %d threads, %ld allocations each, "
+        "%lu from the bootstrap arena over %lu KB, %lu errors\n",
+        nthreads, iterations, bootstrap_blocks,
+        bootstrap_blocks ? (unsigned long)(bootstrap_high - bootstrap_low) >> 10 : 0,
+        errors);
+    if (errors)
+        _exit(1);
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/*
+ * Cost per call of each allocation function, to measure the malloc
+ * wrapper with tracing disabled. Run untraced and with a wrapper
+ * preloaded, without an LTTng session, see wrapper_cost.sh.
+ *
+ *   wrapper_cost [calls]
+ *
+ * The calls are timed in batches, so that reading the clock does not
+ * weigh on them; free() is timed over the blocks of every other test.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <malloc.h>
+
+#define DEFAULT_CALLS 2000000
+#define BATCH 64
+
+enum {
+    OP_MALLOC,
+    OP_CALLOC,
+    OP_REALLOC,
+    OP_MEMALIGN,
+    OP_POSIX_MEMALIGN,
+    OP_FREE,
+    OP_COUNT
+};
+
+static const char *op_names[OP_COUNT] = {
+    "malloc", "calloc", "realloc", "memalign", "posix_memalign", "free"
+};
+
+static uint64_t op_ns[OP_COUNT];
+static uint64_t op_calls[OP_COUNT];
+static void *volatile sink;
+
+static
+uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static
+size_t block_size(int i)
+{
+    return 16 + (i * 24) % 512;
+}
+
+/* Allocate a batch with "op", then free it */
+static
+void run_batch(int op)
+{
+    void *ptrs[BATCH];
+    uint64_t start;
+    int i;
+
+    /* realloc() grows blocks from malloc(), which are not timed */
+    if (op == OP_REALLOC)
+        for (i = 0; i < BATCH; i++)
+            ptrs[i] = malloc(block_size(i));
+
+    start = now_ns();
+    switch (op) {
+    case OP_MALLOC:
+        for (i = 0; i < BATCH; i++)
+            ptrs[i] = malloc(block_size(i));
+        break;
+    case OP_CALLOC:
+        for (i = 0; i < BATCH; i++)
+            ptrs[i] = calloc(1, block_size(i));
+        break;
+    case OP_REALLOC:
+        for (i = 0; i < BATCH; i++)
+            ptrs[i] = realloc(ptrs[i], 2 * block_size(i));
+        break;
+    case OP_MEMALIGN:
+        for (i = 0; i < BATCH; i++)
+            ptrs[i] = memalign(64, block_size(i));
+        break;
+    default:
+        for (i = 0; i < BATCH; i++)
+            if (posix_memalign(&ptrs[i], 64, block_size(i)))
+                ptrs[i] = NULL;
+        break;
+    }
+    op_ns[op] += now_ns() - start;
+    op_calls[op] += BATCH;
+    sink = ptrs[BATCH - 1];
+
+    start = now_ns();
+    for (i = 0; i < BATCH; i++)
+        free(ptrs[i]);
+    op_ns[OP_FREE] += now_ns() - start;
+    op_calls[OP_FREE] += BATCH;
+}
+
+int main(int argc, char **argv)
+{
+    long calls = argc > 1 ? atol(argv[1]) : DEFAULT_CALLS;
+    long batches = calls / BATCH;
+    long b;
+    int op;
+
+    if (batches <= 0) {
+        fprintf(stderr, "usage: %s [calls]\n", argv[0]);
+        return 1;
+    }
+
+    /* Warm up the arenas of the allocator */
+    for (op = OP_MALLOC; op < OP_FREE; op++)
+        for (b = 0; b < 1000; b++)
+            run_batch(op);
+    for (op = 0; op < OP_COUNT; op++)
+        op_ns[op] = op_calls[op] = 0;
+
+    for (op = OP_MALLOC; op < OP_FREE; op++)
+        for (b = 0; b < batches; b++)
+            run_batch(op);
+
+    for (op = 0; op < OP_COUNT; op++)
+        printf(" %s %.1f", op_names[op], (double)op_ns[op] / op_calls[op]);
+    printf(" ns/call\n");
+    return 0;
+}
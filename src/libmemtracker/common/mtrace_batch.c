@@ -0,0 +1,269 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "mtrace_batch.h"
+
+#define DEFAULT_FLUSH_MS 100
+
+/*
+ * Buffers are mapped on demand and never unmapped. A buffer released by
+ * an exiting thread (tid 0) is reused by the next new thread. The lock
+ * is only contended by the timer thread.
+ */
+struct batch {
+    struct batch *next;
+    int lock;
+    pid_t tid;
+    const struct mtrace_batch_def *def;
+    size_t count;
+    struct mtrace_batch_rec recs[MTRACE_BATCH_MAX];
+};
+
+size_t mtrace_batch_size;
+
+static struct batch *batches;
+static __thread struct batch *cur_batch;
+static pthread_key_t batch_key;
+static uint64_t flush_ns = DEFAULT_FLUSH_MS * 1000000ULL;
+
+static
+void lock_batch(struct batch *b)
+{
+    while (__atomic_exchange_n(&b->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&b->lock, __ATOMIC_RELAXED))
+            sched_yield();
+    }
+}
+
+static
+void unlock_batch(struct batch *b)
+{
+    __atomic_store_n(&b->lock, 0, __ATOMIC_RELEASE);
+}
+
+static
+uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Called with the lock held */
+static
+void flush_batch(struct batch *b)
+{
+    if (b->count && b->def && b->def->enabled())
+        b->def->emit(b->tid, b->recs, b->count * sizeof(struct mtrace_batch_rec));
+    b->count = 0;
+}
+
+static
+struct batch *get_batch(void)
+{
+    struct batch *b;
+    pid_t tid;
+
+    if (cur_batch)
+        return cur_batch;
+
+    tid = syscall(SYS_gettid);
+    for (b = __atomic_load_n(&batches, __ATOMIC_ACQUIRE); b; b = b->next) {
+        pid_t none = 0;
+
+        if (__atomic_compare_exchange_n(&b->tid, &none, tid, 0,
+                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+    }
+
+    if (!b) {
+        b = mmap(NULL, sizeof(*b), PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (b == MAP_FAILED)
+            return NULL;
+        b->tid = tid;
+        b->next = __atomic_load_n(&batches, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&batches, &b->next, b, 1,
+                __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+
+    cur_batch = b;
+    pthread_setspecific(batch_key, b);
+    return b;
+}
+
+int mtrace_batch_add(const struct mtrace_batch_def *def, uint16_t op,
+    const void *ptr, size_t size, uint64_t arg, uint64_t weight,
+    uint32_t stack_id)
+{
+    struct mtrace_batch_rec *rec;
+    struct batch *b;
+
+    if (!def->enabled())
+        return 0;
+    b = get_batch();
+    if (!b)
+        return 0;
+
+    lock_batch(b);
+    b->def = def;
+    rec = &b->recs[b->count];
+    rec->timestamp = now_ns();
+    rec->ptr = (uintptr_t)ptr;
+    rec->size = size;
+    rec->arg = arg;
+    rec->weight = weight;
+    rec->stack_id = stack_id;
+    rec->op = op;
+    rec->reserved = 0;
+    if (++b->count >= mtrace_batch_size)
+        flush_batch(b);
+    unlock_batch(b);
+    return 1;
+}
+
+/* Thread exit: flush the buffer and give it back */
+static
+void release_batch(void *arg)
+{
+    struct batch *b = arg;
+
+    lock_batch(b);
+    flush_batch(b);
+    cur_batch = NULL;
+    __atomic_store_n(&b->tid, 0, __ATOMIC_RELEASE);
+    unlock_batch(b);
+}
+
+/*
+ * Flush the buffers whose oldest record is older than the period, or
+ * all of them. The buffers being filled are skipped.
+ */
+static
+void flush_stale(int all)
+{
+    uint64_t now = now_ns();
+    struct batch *b;
+
+    for (b = __atomic_load_n(&batches, __ATOMIC_ACQUIRE); b; b = b->next) {
+        if (!b->count)
+            continue;
+        if (all) {
+            lock_batch(b);
+        } else if (__atomic_exchange_n(&b->lock, 1, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        if (b->count && (all || now - b->recs[0].timestamp >= flush_ns))
+            flush_batch(b);
+        unlock_batch(b);
+    }
+}
+
+static
+void *timer_thread(void *arg)
+{
+    struct timespec period;
+
+    period.tv_sec = flush_ns / 1000000000ULL;
+    period.tv_nsec = flush_ns % 1000000000ULL;
+    for (;;) {
+        nanosleep(&period, NULL);
+        flush_stale(0);
+    }
+    return NULL;
+}
+
+static
+void start_timer(void)
+{
+    pthread_attr_t attr;
+    pthread_t thread;
+    sigset_t all, old;
+
+    /* The timer thread must not take the signals of the application */
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    pthread_create(&thread, &attr, timer_thread, NULL);
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+}
+
+/* Only the forking thread lives on in the child */
+static
+void atfork_child(void)
+{
+    struct batch *b;
+
+    for (b = batches; b; b = b->next) {
+        b->lock = 0;
+        if (b != cur_batch) {
+            b->count = 0;
+            b->tid = 0;
+        }
+    }
+    if (cur_batch)
+        cur_batch->tid = syscall(SYS_gettid);
+    start_timer();
+}
+
+void mtrace_batch_init(void)
+{
+    const char *env = getenv("MTRACE_BATCH");
+    long size;
+
+    if (!env || mtrace_batch_size)
+        return;
+
+    size = strtol(env, NULL, 10);
+    if (size < 1)
+        return;
+    if (size > MTRACE_BATCH_MAX)
+        size = MTRACE_BATCH_MAX;
+
+    env = getenv("MTRACE_BATCH_FLUSH_MS");
+    if (env && strtol(env, NULL, 10) > 0)
+        flush_ns = strtol(env, NULL, 10) * 1000000ULL;
+
+    if (pthread_key_create(&batch_key, release_batch) != 0)
+        return;
+
+    start_timer();
+    pthread_atfork(NULL, NULL, atfork_child);
+    mtrace_batch_size = size;
+}
+
+__attribute__((destructor))
+static
+void mtrace_batch_fini(void)
+{
+    if (mtrace_batch_size)
+        flush_stale(1);
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _MTRACE_BATCH_H
+#define _MTRACE_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Per-thread event batching.
+ *
+ * With MTRACE_BATCH=<n>, the wrappers append their records to a buffer
+ * of the thread instead of tracing each of them, and the buffer is
+ * recorded as a single "alloc_batch" event every n records (at most
+ * MTRACE_BATCH_MAX). Buffers are also flushed when their thread exits,
+ * at process exit, and by a timer thread when their oldest record is
+ * older than MTRACE_BATCH_FLUSH_MS (default 100).
+ *
+ * The events enabled in the session still select which records are
+ * taken. When alloc_batch itself is disabled, the wrappers fall back to
+ * the individual events.
+ */
+#define MTRACE_BATCH_MAX 128
+
+enum {
+    MTRACE_OP_MALLOC,
+    MTRACE_OP_CALLOC,
+    MTRACE_OP_REALLOC,
+    MTRACE_OP_MEMALIGN,
+    MTRACE_OP_POSIX_MEMALIGN,
+    MTRACE_OP_FREE,
+    MTRACE_OP_NEW,
+    MTRACE_OP_NEW_ARR,
+    MTRACE_OP_DELETE,
+    MTRACE_OP_DELETE_ARR,
+};
+
+/*
+ * Record of the alloc_batch payload, in the byte order of the host.
+ * "arg" is the old block of realloc, the alignment of the aligned
+ * allocations, and the element count of calloc.
+ */
+struct mtrace_batch_rec {
+    uint64_t timestamp;     /* CLOCK_MONOTONIC, in ns */
+    uint64_t ptr;
+    uint64_t size;
+    uint64_t arg;
+    uint64_t weight;
+    uint32_t stack_id;
+    uint16_t op;
+    uint16_t reserved;
+};
+
+/* "emit" records one alloc_batch event, "enabled" tells whether it is enabled */
+struct mtrace_batch_def {
+    int (*enabled)(void);
+    void (*emit)(pid_t tid, const void *recs, size_t len);
+};
+
+extern size_t mtrace_batch_size __attribute__((visibility("hidden")));
+
+void mtrace_batch_init(void) __attribute__((visibility("hidden")));
+
+/* Return 0 when the record was not taken, and must be traced by itself */
+int mtrace_batch_add(const struct mtrace_batch_def *def, uint16_t op,
+    const void *ptr, size_t size, uint64_t arg, uint64_t weight,
+    uint32_t stack_id) __attribute__((visibility("hidden")));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MTRACE_BATCH_H */
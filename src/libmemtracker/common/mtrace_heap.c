@@ -0,0 +1,674 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "mtrace_heap.h"
+#include "mtrace_stack.h"
+
+#define DEFAULT_HEAP_ENTRIES    (1 << 20)
+
+/* Must be a power of 2 */
+#define SHARD_COUNT     256
+
+/* A site per stack ID, and site 0 */
+#define SITE_COUNT      (MTRACE_STACK_MAX_ID + 1)
+
+/*
+ * Lifetimes of the freed blocks are counted in decades from 1 us up to
+ * 10 s, and sizes in powers of 2 from 16 bytes up to 256 KB. Blocks
+ * freed within CHURN_BUCKETS decades (1 ms) count as churn.
+ */
+#define LIFETIME_BUCKETS    9
+#define SIZE_CLASSES        16
+#define CHURN_BUCKETS       4
+#define TOP_CHURN_SITES     32
+
+/*
+ * Blocks are spread over shards, each an open-addressing table with
+ * linear probing under its own spinlock. Deletion shifts the following
+ * entries back, so churn leaves no tombstones behind.
+ */
+struct heap_entry {
+    void *ptr;
+    size_t size;
+    uint64_t alloc_ns;
+    uint32_t stack_id;
+};
+
+struct heap_shard {
+    int lock;
+    uint32_t count;
+    struct heap_entry *entries;
+    char pad[64 - sizeof(int) - sizeof(uint32_t) - sizeof(void *)];
+};
+
+/*
+ * Per call site, indexed by stack ID. Site 0 collects the stacks which
+ * found no room in the stack table (MTRACE_STACK_OVERFLOW_ID).
+ */
+struct heap_site {
+    uint64_t live_bytes;
+    uint64_t live_count;
+    uint64_t total_count;
+    uint64_t churn_bytes;
+    uint64_t churn_count;
+    uint64_t lifetime[LIFETIME_BUCKETS];
+};
+
+int mtrace_heap_mode;
+
+static struct heap_shard shards[SHARD_COUNT];
+static size_t shard_size;
+static struct heap_site *sites;
+
+static uint64_t untracked;
+
+/* Freed blocks by size class and lifetime */
+static uint64_t histogram[SIZE_CLASSES][LIFETIME_BUCKETS];
+
+static const char *const lifetime_names[LIFETIME_BUCKETS] = {
+    "<1us", "<10us", "<100us", "<1ms", "<10ms", "<100ms", "<1s", "<10s", ">=10s"
+};
+
+/* Preallocated for the report, which may be written in a signal handler */
+static uint32_t *sort_buf;
+static char dump_path[256];
+static int dumping;
+
+struct writer {
+    int fd;
+    size_t len;
+    char buf[4096];
+};
+
+static struct writer report;
+
+static
+void lock_shard(struct heap_shard *shard)
+{
+    while (__atomic_exchange_n(&shard->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&shard->lock, __ATOMIC_RELAXED))
+            sched_yield();
+    }
+}
+
+static
+void unlock_shard(struct heap_shard *shard)
+{
+    __atomic_store_n(&shard->lock, 0, __ATOMIC_RELEASE);
+}
+
+static
+uint64_t hash_ptr(void *ptr)
+{
+    uint64_t h = (uintptr_t)ptr >> 4;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static
+struct heap_site *get_site(uint32_t stack_id)
+{
+    return &sites[stack_id < SITE_COUNT ? stack_id : 0];
+}
+
+static
+void site_add(uint32_t stack_id, size_t size)
+{
+    struct heap_site *site = get_site(stack_id);
+
+    __atomic_add_fetch(&site->live_bytes, size, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&site->live_count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&site->total_count, 1, __ATOMIC_RELAXED);
+}
+
+static
+void site_sub(uint32_t stack_id, size_t size)
+{
+    struct heap_site *site = get_site(stack_id);
+
+    __atomic_sub_fetch(&site->live_bytes, size, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&site->live_count, 1, __ATOMIC_RELAXED);
+}
+
+static
+uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static
+unsigned int lifetime_bucket(uint64_t ns)
+{
+    uint64_t limit = 1000;
+    unsigned int b = 0;
+
+    while (b < LIFETIME_BUCKETS - 1 && ns >= limit) {
+        limit *= 10;
+        b++;
+    }
+    return b;
+}
+
+static
+unsigned int size_class(size_t size)
+{
+    unsigned int c = 0;
+
+    while (c < SIZE_CLASSES - 1 && size > ((size_t)16 << c))
+        c++;
+    return c;
+}
+
+/* Account the lifetime of a freed block */
+static
+void site_freed(const struct heap_entry *entry, uint64_t now)
+{
+    struct heap_site *site = get_site(entry->stack_id);
+    unsigned int b = lifetime_bucket(now - entry->alloc_ns);
+
+    __atomic_add_fetch(&site->lifetime[b], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&histogram[size_class(entry->size)][b], 1, __ATOMIC_RELAXED);
+    if (b < CHURN_BUCKETS) {
+        __atomic_add_fetch(&site->churn_bytes, entry->size, __ATOMIC_RELAXED);
+        __atomic_add_fetch(&site->churn_count, 1, __ATOMIC_RELAXED);
+    }
+}
+
+void mtrace_heap_alloc(void *ptr, size_t size, uint32_t stack_id)
+{
+    uint64_t h = hash_ptr(ptr);
+    struct heap_shard *shard = &shards[h & (SHARD_COUNT - 1)];
+    size_t mask = shard_size - 1;
+    uint64_t now;
+    size_t i;
+
+    if (!ptr)
+        return;
+    now = now_ns();
+
+    lock_shard(shard);
+
+    /* Keep the table sparse enough for short probes */
+    if (shard->count >= shard_size - shard_size / 8) {
+        unlock_shard(shard);
+        __atomic_add_fetch(&untracked, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    for (i = (h >> 8) & mask; ; i = (i + 1) & mask) {
+        struct heap_entry *entry = &shard->entries[i];
+
+        if (entry->ptr == ptr) {
+            /* Its free() was missed. Account the block anew. */
+            site_sub(entry->stack_id, entry->size);
+            break;
+        }
+        if (!entry->ptr) {
+            shard->count++;
+            break;
+        }
+    }
+    shard->entries[i].ptr = ptr;
+    shard->entries[i].size = size;
+    shard->entries[i].alloc_ns = now;
+    shard->entries[i].stack_id = stack_id;
+    site_add(stack_id, size);
+
+    unlock_shard(shard);
+}
+
+int mtrace_heap_free(void *ptr, struct mtrace_heap_block *block)
+{
+    uint64_t h = hash_ptr(ptr);
+    struct heap_shard *shard = &shards[h & (SHARD_COUNT - 1)];
+    size_t mask = shard_size - 1;
+    uint64_t now;
+    size_t i, j;
+
+    if (!ptr)
+        return 0;
+    now = now_ns();
+
+    lock_shard(shard);
+
+    for (i = (h >> 8) & mask; shard->entries[i].ptr != ptr; i = (i + 1) & mask) {
+        if (!shard->entries[i].ptr) {
+            unlock_shard(shard);
+            return 0;
+        }
+    }
+
+    site_sub(shard->entries[i].stack_id, shard->entries[i].size);
+    site_freed(&shard->entries[i], now);
+    if (block) {
+        block->size = shard->entries[i].size;
+        block->stack_id = shard->entries[i].stack_id;
+    }
+
+    /* Move back the entries which probed past the removed one */
+    for (j = (i + 1) & mask; shard->entries[j].ptr; j = (j + 1) & mask) {
+        size_t home = (hash_ptr(shard->entries[j].ptr) >> 8) & mask;
+
+        if (((j - home) & mask) >= ((j - i) & mask)) {
+            shard->entries[i] = shard->entries[j];
+            i = j;
+        }
+    }
+    shard->entries[i].ptr = NULL;
+    shard->count--;
+
+    unlock_shard(shard);
+    return 1;
+}
+
+/*
+    Report
+*/
+static
+void flush_report(struct writer *w)
+{
+    const char *p = w->buf;
+
+    while (w->len > 0) {
+        ssize_t n = write(w->fd, p, w->len);
+
+        if (n <= 0)
+            break;
+        p += n;
+        w->len -= n;
+    }
+    w->len = 0;
+}
+
+static
+void put_str(struct writer *w, const char *str)
+{
+    while (*str) {
+        if (w->len == sizeof(w->buf))
+            flush_report(w);
+        w->buf[w->len++] = *str++;
+    }
+}
+
+static
+void put_num(struct writer *w, uint64_t value, unsigned int base)
+{
+    char digits[24];
+    int n = sizeof(digits) - 1;
+
+    digits[n] = '\0';
+    do {
+        digits[--n] = "0123456789abcdef"[value % base];
+        value /= base;
+    } while (value);
+
+    if (base == 16)
+        put_str(w, "0x");
+    put_str(w, &digits[n]);
+}
+
+static
+uint64_t by_live_bytes(const struct heap_site *site)
+{
+    return site->live_bytes;
+}
+
+static
+uint64_t by_churn_count(const struct heap_site *site)
+{
+    return site->churn_count;
+}
+
+static
+int site_before(uint32_t a, uint32_t b, uint64_t (*key)(const struct heap_site *))
+{
+    return key(&sites[a]) < key(&sites[b]);
+}
+
+/* Heapsort of the site indexes by "key", largest first */
+static
+void sort_sites(uint32_t *idx, size_t n, uint64_t (*key)(const struct heap_site *))
+{
+    size_t start, end, root, child;
+    uint32_t tmp;
+
+    for (start = n / 2; start-- > 0; ) {
+        for (root = start; (child = 2 * root + 1) < n; root = child) {
+            if (child + 1 < n && site_before(idx[child + 1], idx[child], key))
+                child++;
+            if (!site_before(idx[child], idx[root], key))
+                break;
+            tmp = idx[root]; idx[root] = idx[child]; idx[child] = tmp;
+        }
+    }
+    for (end = n; end-- > 1; ) {
+        tmp = idx[0]; idx[0] = idx[end]; idx[end] = tmp;
+        for (root = 0; (child = 2 * root + 1) < end; root = child) {
+            if (child + 1 < end && site_before(idx[child + 1], idx[child], key))
+                child++;
+            if (!site_before(idx[child], idx[root], key))
+                break;
+            tmp = idx[root]; idx[root] = idx[child]; idx[child] = tmp;
+        }
+    }
+}
+
+static
+void put_frames(struct writer *w, uint32_t stack_id)
+{
+    size_t depth = 0, k;
+    void **frames = mtrace_stack_get(stack_id, &depth);
+
+    for (k = 0; frames && k < depth; k++) {
+        put_str(w, " ");
+        put_num(w, (uintptr_t)frames[k], 16);
+    }
+}
+
+static
+void put_histogram(struct writer *w)
+{
+    unsigned int c, b;
+
+    put_str(w, "# lifetime histogram: freed blocks by size class and lifetime\n");
+    put_str(w, "# size");
+    for (b = 0; b < LIFETIME_BUCKETS; b++) {
+        put_str(w, " ");
+        put_str(w, lifetime_names[b]);
+    }
+    put_str(w, "\n");
+
+    for (c = 0; c < SIZE_CLASSES; c++) {
+        if (c == SIZE_CLASSES - 1) {
+            put_str(w, ">");
+            put_num(w, (uint64_t)16 << (c - 1), 10);
+        } else {
+            put_str(w, "<=");
+            put_num(w, (uint64_t)16 << c, 10);
+        }
+        for (b = 0; b < LIFETIME_BUCKETS; b++) {
+            put_str(w, " ");
+            put_num(w, __atomic_load_n(&histogram[c][b], __ATOMIC_RELAXED), 10);
+        }
+        put_str(w, "\n");
+    }
+}
+
+/* The sites freeing the most blocks within 1 ms, with their lifetimes */
+static
+void put_churn(struct writer *w)
+{
+    size_t n = 0, i;
+    uint32_t id;
+    unsigned int b;
+
+    for (id = 0; id < SITE_COUNT; id++) {
+        if (__atomic_load_n(&sites[id].churn_count, __ATOMIC_RELAXED))
+            sort_buf[n++] = id;
+    }
+    sort_sites(sort_buf, n, by_churn_count);
+
+    put_str(w, "# churn: blocks freed within 1ms\n");
+    put_str(w, "# churn_count churn_bytes total_count stack_id: frames\n");
+    put_str(w, "#   lifetime");
+    for (b = 0; b < LIFETIME_BUCKETS; b++) {
+        put_str(w, " ");
+        put_str(w, lifetime_names[b]);
+    }
+    put_str(w, "\n");
+
+    for (i = 0; i < n && i < TOP_CHURN_SITES; i++) {
+        struct heap_site *site = &sites[sort_buf[i]];
+
+        put_num(w, site->churn_count, 10);
+        put_str(w, " ");
+        put_num(w, site->churn_bytes, 10);
+        put_str(w, " ");
+        put_num(w, site->total_count, 10);
+        put_str(w, " ");
+        put_num(w, sort_buf[i], 10);
+        put_str(w, ":");
+        put_frames(w, sort_buf[i]);
+        put_str(w, "\n    lifetime");
+        for (b = 0; b < LIFETIME_BUCKETS; b++) {
+            put_str(w, " ");
+            put_num(w, site->lifetime[b], 10);
+        }
+        put_str(w, "\n");
+    }
+}
+
+static
+void put_maps(struct writer *w)
+{
+    int fd = open("/proc/self/maps", O_RDONLY);
+    ssize_t n;
+
+    if (fd < 0)
+        return;
+
+    flush_report(w);
+    while ((n = read(fd, w->buf, sizeof(w->buf))) > 0) {
+        w->len = n;
+        flush_report(w);
+    }
+    close(fd);
+}
+
+void mtrace_heap_dump(void)
+{
+    struct writer *w = &report;
+    uint64_t live_bytes = 0, live_count = 0;
+    size_t n = 0;
+    uint32_t i;
+    int expected = 0;
+
+    if (!mtrace_heap_mode || !__atomic_compare_exchange_n(&dumping, &expected, 1,
+            0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+
+    w->fd = open(dump_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    w->len = 0;
+    if (w->fd < 0)
+        goto out;
+
+    for (i = 0; i < SITE_COUNT; i++) {
+        if (__atomic_load_n(&sites[i].live_count, __ATOMIC_RELAXED) == 0)
+            continue;
+        live_bytes += sites[i].live_bytes;
+        live_count += sites[i].live_count;
+        sort_buf[n++] = i;
+    }
+    sort_sites(sort_buf, n, by_live_bytes);
+
+    put_str(w, "# mtrace heap report, pid ");
+    put_num(w, getpid(), 10);
+    put_str(w, "\n# live_bytes ");
+    put_num(w, live_bytes, 10);
+    put_str(w, " live_count ");
+    put_num(w, live_count, 10);
+    put_str(w, " sites ");
+    put_num(w, n, 10);
+    put_str(w, " untracked ");
+    put_num(w, __atomic_load_n(&untracked, __ATOMIC_RELAXED), 10);
+    put_str(w, " stack_overflows ");
+    put_num(w, mtrace_stack_overflows(), 10);
+    put_str(w, "\n# live_bytes live_count total_count stack_id: frames\n");
+
+    for (i = 0; i < n; i++) {
+        struct heap_site *site = &sites[sort_buf[i]];
+
+        put_num(w, site->live_bytes, 10);
+        put_str(w, " ");
+        put_num(w, site->live_count, 10);
+        put_str(w, " ");
+        put_num(w, site->total_count, 10);
+        put_str(w, " ");
+        put_num(w, sort_buf[i], 10);
+        put_str(w, ":");
+        put_frames(w, sort_buf[i]);
+        put_str(w, "\n");
+    }
+
+    put_histogram(w);
+    put_churn(w);
+
+    /* For offline symbolization of the frames */
+    put_str(w, "# maps\n");
+    put_maps(w);
+
+    flush_report(w);
+    close(w->fd);
+out:
+    __atomic_store_n(&dumping, 0, __ATOMIC_RELEASE);
+}
+
+/*
+    Initialization
+*/
+static
+void dump_handler(int sig)
+{
+    mtrace_heap_dump();
+}
+
+static
+void atfork_prepare(void)
+{
+    int i;
+
+    for (i = 0; i < SHARD_COUNT; i++)
+        lock_shard(&shards[i]);
+}
+
+static
+void atfork_release(void)
+{
+    int i;
+
+    for (i = SHARD_COUNT - 1; i >= 0; i--)
+        unlock_shard(&shards[i]);
+}
+
+static
+void atfork_child(void)
+{
+    atfork_release();
+
+    /* The child writes its own report */
+    if (!getenv("MTRACE_HEAP_DUMP")) {
+        char *p = dump_path + sizeof("/tmp/mtrace-") - 1;
+        struct writer w;
+
+        w.len = 0;
+        put_num(&w, getpid(), 10);
+        memcpy(p, w.buf, w.len);
+        memcpy(p + w.len, ".heap", sizeof(".heap"));
+    }
+}
+
+static
+void *map_zero(size_t size)
+{
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    return addr == MAP_FAILED ? NULL : addr;
+}
+
+void mtrace_heap_init(void)
+{
+    const char *env = getenv("MTRACE_MODE");
+    size_t entries = DEFAULT_HEAP_ENTRIES;
+    struct heap_entry *table;
+    struct sigaction sa;
+    int sig = SIGUSR1;
+    int i;
+
+    if (!env || strcmp(env, "heap") != 0 || mtrace_heap_mode)
+        return;
+
+    env = getenv("MTRACE_HEAP_ENTRIES");
+    if (env && strtoul(env, NULL, 10) > 0)
+        entries = strtoul(env, NULL, 10);
+
+    shard_size = 16;
+    while (shard_size * SHARD_COUNT < entries)
+        shard_size <<= 1;
+
+    table = map_zero(shard_size * SHARD_COUNT * sizeof(struct heap_entry));
+    sites = map_zero(SITE_COUNT * sizeof(struct heap_site));
+    sort_buf = map_zero(SITE_COUNT * sizeof(uint32_t));
+    if (!table || !sites || !sort_buf)
+        return;
+
+    for (i = 0; i < SHARD_COUNT; i++)
+        shards[i].entries = table + (size_t)i * shard_size;
+
+    env = getenv("MTRACE_HEAP_DUMP");
+    if (env) {
+        strncpy(dump_path, env, sizeof(dump_path) - 1);
+    } else {
+        struct writer w;
+
+        w.len = 0;
+        put_str(&w, "/tmp/mtrace-");
+        put_num(&w, getpid(), 10);
+        put_str(&w, ".heap");
+        memcpy(dump_path, w.buf, w.len);
+    }
+
+    env = getenv("MTRACE_HEAP_SIGNAL");
+    if (env)
+        sig = atoi(env);
+
+    /* Leave the signal alone when the application uses it */
+    if (sig > 0 && sigaction(sig, NULL, &sa) == 0 && sa.sa_handler == SIG_DFL) {
+        memset(&sa, 0, sizeof(sa));
+        sigemptyset(&sa.sa_mask);
+        sa.sa_flags = SA_RESTART;
+        sa.sa_handler = dump_handler;
+        sigaction(sig, &sa, NULL);
+    }
+
+    pthread_atfork(atfork_prepare, atfork_release, atfork_child);
+    mtrace_heap_mode = 1;
+}
+
+__attribute__((destructor))
+static
+void mtrace_heap_fini(void)
+{
+    mtrace_heap_dump();
+}
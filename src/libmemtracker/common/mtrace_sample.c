@@ -0,0 +1,280 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "mtrace_sample.h"
+
+/* Must be powers of 2 */
+#define TRACKED_SHARDS      64
+#define TRACKED_SHARD_SIZE  1024
+#define FILTER_SIZE         65536
+
+/*
+ * Tracked blocks are spread over shards like the blocks of the heap
+ * table: open addressing, linear probing, one spinlock per shard. The
+ * filter counts the tracked blocks by another part of their hash, so
+ * that releasing a block which was not sampled, the common case, takes
+ * a single load.
+ */
+struct tracked_entry {
+    void *ptr;
+    uint64_t weight;
+};
+
+struct tracked_shard {
+    int lock;
+    uint32_t count;
+    struct tracked_entry *entries;
+    char pad[64 - sizeof(int) - sizeof(uint32_t) - sizeof(void *)];
+};
+
+size_t mtrace_sample_interval;
+__thread int64_t mtrace_sample_countdown;
+
+static __thread uint64_t sample_rng;
+
+static struct tracked_shard tracked[TRACKED_SHARDS];
+static uint16_t *tracked_filter;
+static uint64_t untracked;
+
+/* xorshift64*, seeded per thread */
+static
+uint64_t sample_random(void)
+{
+    uint64_t x = sample_rng;
+
+    if (!x) {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        x = ((uint64_t)syscall(SYS_gettid) << 32) ^ (uint64_t)ts.tv_nsec ^
+            (uint64_t)(uintptr_t)&sample_rng;
+        if (!x)
+            x = 1;
+    }
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    sample_rng = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+static
+int64_t next_countdown(void)
+{
+    /* Uniform in (0, 1] from the top 53 bits */
+    double u = ((sample_random() >> 11) + 1) * (1.0 / 9007199254740992.0);
+    double bytes = -log(u) * (double)mtrace_sample_interval;
+
+    if (bytes < 1)
+        return 1;
+    if (bytes > (double)(mtrace_sample_interval * 64))
+        return mtrace_sample_interval * 64;
+    return (int64_t)bytes;
+}
+
+uint64_t mtrace_sample_slow(size_t size)
+{
+    uint64_t samples = 0;
+
+    /* The first allocation of a thread only draws its countdown */
+    if (!sample_rng) {
+        mtrace_sample_countdown += next_countdown();
+        if (mtrace_sample_countdown > 0)
+            return 0;
+    }
+
+    /* An allocation larger than the interval stands for several samples */
+    while (mtrace_sample_countdown <= 0) {
+        mtrace_sample_countdown += next_countdown();
+        samples++;
+    }
+    return samples * mtrace_sample_interval;
+}
+
+static
+void lock_shard(struct tracked_shard *shard)
+{
+    while (__atomic_exchange_n(&shard->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&shard->lock, __ATOMIC_RELAXED))
+            sched_yield();
+    }
+}
+
+static
+void unlock_shard(struct tracked_shard *shard)
+{
+    __atomic_store_n(&shard->lock, 0, __ATOMIC_RELEASE);
+}
+
+static
+uint64_t hash_ptr(void *ptr)
+{
+    uint64_t h = (uintptr_t)ptr >> 4;
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+#define FILTER_INDEX(h) (((h) >> 32) & (FILTER_SIZE - 1))
+#define SHARD_MASK (TRACKED_SHARD_SIZE - 1)
+
+void mtrace_sample_track(void *ptr, uint64_t weight)
+{
+    uint64_t h = hash_ptr(ptr);
+    struct tracked_shard *shard = &tracked[h & (TRACKED_SHARDS - 1)];
+    uint16_t *filter = __atomic_load_n(&tracked_filter, __ATOMIC_ACQUIRE);
+    size_t i;
+
+    if (!ptr || !filter)
+        return;
+
+    lock_shard(shard);
+
+    /* Keep the table sparse enough for short probes */
+    if (shard->count >= TRACKED_SHARD_SIZE - TRACKED_SHARD_SIZE / 8) {
+        unlock_shard(shard);
+        __atomic_add_fetch(&untracked, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    for (i = (h >> 8) & SHARD_MASK; ; i = (i + 1) & SHARD_MASK) {
+        struct tracked_entry *entry = &shard->entries[i];
+
+        /* Its release was missed */
+        if (entry->ptr == ptr)
+            break;
+        if (!entry->ptr) {
+            shard->count++;
+            __atomic_add_fetch(&filter[FILTER_INDEX(h)], 1, __ATOMIC_RELAXED);
+            break;
+        }
+    }
+    shard->entries[i].ptr = ptr;
+    shard->entries[i].weight = weight;
+
+    unlock_shard(shard);
+}
+
+int mtrace_sample_untrack(void *ptr, uint64_t *weight)
+{
+    uint64_t h = hash_ptr(ptr);
+    struct tracked_shard *shard = &tracked[h & (TRACKED_SHARDS - 1)];
+    uint16_t *filter = __atomic_load_n(&tracked_filter, __ATOMIC_ACQUIRE);
+    size_t i, j;
+
+    if (!ptr || !filter || !__atomic_load_n(&filter[FILTER_INDEX(h)], __ATOMIC_RELAXED))
+        return 0;
+
+    lock_shard(shard);
+
+    for (i = (h >> 8) & SHARD_MASK; shard->entries[i].ptr != ptr; i = (i + 1) & SHARD_MASK) {
+        if (!shard->entries[i].ptr) {
+            unlock_shard(shard);
+            return 0;
+        }
+    }
+    *weight = shard->entries[i].weight;
+
+    /* Move back the entries which probed past the removed one */
+    for (j = (i + 1) & SHARD_MASK; shard->entries[j].ptr; j = (j + 1) & SHARD_MASK) {
+        size_t home = (hash_ptr(shard->entries[j].ptr) >> 8) & SHARD_MASK;
+
+        if (((j - home) & SHARD_MASK) >= ((j - i) & SHARD_MASK)) {
+            shard->entries[i] = shard->entries[j];
+            i = j;
+        }
+    }
+    shard->entries[i].ptr = NULL;
+    shard->count--;
+    __atomic_sub_fetch(&filter[FILTER_INDEX(h)], 1, __ATOMIC_RELAXED);
+
+    unlock_shard(shard);
+    return 1;
+}
+
+static
+void atfork_prepare(void)
+{
+    int i;
+
+    for (i = 0; i < TRACKED_SHARDS; i++)
+        lock_shard(&tracked[i]);
+}
+
+/* The blocks live on in the child, and stay tracked */
+static
+void atfork_release(void)
+{
+    int i;
+
+    for (i = TRACKED_SHARDS - 1; i >= 0; i--)
+        unlock_shard(&tracked[i]);
+}
+
+static
+void *map_zero(size_t size)
+{
+    void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+    return addr == MAP_FAILED ? NULL : addr;
+}
+
+void mtrace_sample_init(void)
+{
+    const char *env = getenv("MTRACE_SAMPLE_BYTES");
+    struct tracked_entry *table;
+    uint16_t *filter;
+    int i;
+
+    if (env)
+        mtrace_sample_interval = strtoul(env, NULL, 10);
+    if (!mtrace_sample_interval || tracked_filter)
+        return;
+
+    table = map_zero(TRACKED_SHARDS * TRACKED_SHARD_SIZE * sizeof(struct tracked_entry));
+    filter = map_zero(FILTER_SIZE * sizeof(uint16_t));
+    if (!table || !filter)
+        return;
+
+    for (i = 0; i < TRACKED_SHARDS; i++)
+        tracked[i].entries = table + (size_t)i * TRACKED_SHARD_SIZE;
+    pthread_atfork(atfork_prepare, atfork_release, atfork_release);
+    __atomic_store_n(&tracked_filter, filter, __ATOMIC_RELEASE);
+}
+
+__attribute__((destructor))
+static
+void mtrace_sample_fini(void)
+{
+    uint64_t count = __atomic_load_n(&untracked, __ATOMIC_RELAXED);
+
+    if (count)
+        fprintf(stderr, "mtrace: %llu sampled blocks found no room to be tracked, "
+            "their release was not traced\n", (unsigned long long)count);
+}
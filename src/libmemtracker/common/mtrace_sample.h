@@ -0,0 +1,85 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _MTRACE_SAMPLE_H
+#define _MTRACE_SAMPLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Allocation sampling.
+ *
+ * MTRACE_SAMPLE_BYTES sets the mean number of bytes allocated between
+ * two samples. Each thread counts down the bytes it allocates, and the
+ * allocation that crosses zero is sampled, the next countdown being
+ * drawn from an exponential distribution (a Poisson process over the
+ * allocated bytes). Only sampled allocations are unwound and traced.
+ *
+ * The weight of a sample is the number of bytes it stands for, so tools
+ * rescale by summing the weights instead of the sizes. Without sampling
+ * every allocation is recorded with its own size as weight.
+ */
+extern size_t mtrace_sample_interval __attribute__((visibility("hidden")));
+extern __thread int64_t mtrace_sample_countdown __attribute__((visibility("hidden")));
+
+void mtrace_sample_init(void) __attribute__((visibility("hidden")));
+
+uint64_t mtrace_sample_slow(size_t size) __attribute__((visibility("hidden")));
+
+/*
+ * Sampled blocks whose allocation was traced, with their weight, so that
+ * only their releases are traced. Used with MTRACE_SAMPLE_BYTES when the
+ * heap mode is off (its table has the sampled blocks already). A block
+ * which finds no room is counted, reported at exit, and its release is
+ * not traced.
+ */
+void mtrace_sample_track(void *ptr, uint64_t weight) __attribute__((visibility("hidden")));
+
+/*
+ * Forget a block before it is released. Returns 1 and its weight in
+ * "weight" if it was tracked.
+ */
+int mtrace_sample_untrack(void *ptr, uint64_t *weight) __attribute__((visibility("hidden")));
+
+/*
+ * Return non-zero when the allocation is sampled, and its weight in
+ * "weight". The weight may be 0 without sampling (malloc(0) and the
+ * like), which is still recorded so that its free() has a match.
+ */
+static inline __attribute__((always_inline))
+int mtrace_sample(size_t size, uint64_t *weight)
+{
+    if (!mtrace_sample_interval) {
+        *weight = size;
+        return 1;
+    }
+    mtrace_sample_countdown -= size;
+    if (mtrace_sample_countdown > 0)
+        return 0;
+    *weight = mtrace_sample_slow(size);
+    return *weight != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MTRACE_SAMPLE_H */
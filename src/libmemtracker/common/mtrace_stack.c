@@ -0,0 +1,200 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+#include <sys/mman.h>
+
+#include "mtrace_stack.h"
+#include "mtrace_unwind.h"
+
+/*
+ * Lock-free open-addressing table. It lives in its own mapping, so it
+ * never calls back into the allocation wrappers. Pages are only
+ * committed as entries get used.
+ */
+
+/* Must be a power of 2. Holds the IDs up to MTRACE_STACK_MAX_ID. */
+#define STACK_TABLE_SIZE    MTRACE_STACK_MAX_ID
+#define STACK_MAX_PROBES    64
+
+#define ENTRY_EMPTY     0
+#define ENTRY_BUSY      1
+#define ENTRY_READY     2
+
+struct stack_entry {
+    int state;
+    uint32_t hash;
+    uint32_t id;
+    unsigned int gen;
+    size_t depth;
+    void *frames[MTRACE_BT_MAX_DEPTH];
+};
+
+/* Indexed by the hash, and followed by the index by ID for mtrace_stack_get() */
+static struct stack_entry *stack_table;
+#define ID_TABLE(table) ((struct stack_entry **)((table) + STACK_TABLE_SIZE))
+static uint32_t last_id;
+
+/*
+ * Each entry keeps the generation of its last stack_def. A new session
+ * enabling stack_def starts a new generation, so that every stack of the
+ * table is defined again on its next use.
+ */
+static unsigned int def_gen = 1;
+static int def_enabled;
+
+/* Generation of the last stack_def of MTRACE_STACK_OVERFLOW_ID */
+static unsigned int overflow_gen;
+static uint64_t overflow_count;
+
+static
+struct stack_entry *get_table(void)
+{
+    struct stack_entry *table = __atomic_load_n(&stack_table, __ATOMIC_ACQUIRE);
+    struct stack_entry *expected = NULL;
+    size_t size = STACK_TABLE_SIZE * sizeof(struct stack_entry) +
+        (STACK_TABLE_SIZE + 1) * sizeof(struct stack_entry *);
+
+    if (table)
+        return table;
+
+    table = mmap(NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (table == MAP_FAILED)
+        return NULL;
+
+    if (!__atomic_compare_exchange_n(&stack_table, &expected, table,
+            0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        munmap(table, size);
+        table = expected;
+    }
+    return table;
+}
+
+static
+uint32_t hash_stack(void **bt, size_t depth)
+{
+    uint64_t hash = depth;
+    size_t i;
+
+    for (i = 0; i < depth; i++) {
+        hash ^= (uintptr_t)bt[i];
+        hash *= 0x100000001b3ULL;
+        hash ^= hash >> 29;
+    }
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+static
+int stack_def_enabled(const struct mtrace_stack_def *def)
+{
+    int enabled = def->enabled() ? 1 : 0;
+
+    if (__atomic_load_n(&def_enabled, __ATOMIC_RELAXED) != enabled &&
+            __atomic_exchange_n(&def_enabled, enabled, __ATOMIC_RELAXED) != enabled &&
+            enabled) {
+        __atomic_add_fetch(&def_gen, 1, __ATOMIC_RELAXED);
+    }
+    return enabled;
+}
+
+static
+void define_stack(struct stack_entry *entry, int enabled, const struct mtrace_stack_def *def)
+{
+    unsigned int gen = __atomic_load_n(&def_gen, __ATOMIC_RELAXED);
+
+    if (!enabled || __atomic_load_n(&entry->gen, __ATOMIC_RELAXED) == gen)
+        return;
+
+    __atomic_store_n(&entry->gen, gen, __ATOMIC_RELAXED);
+    def->emit(entry->id, entry->frames, entry->depth);
+}
+
+uint32_t mtrace_stack_id(void **bt, size_t depth, const struct mtrace_stack_def *def)
+{
+    struct stack_entry *table = get_table();
+    int enabled = stack_def_enabled(def);
+    uint32_t hash;
+    unsigned int gen;
+    unsigned int i;
+
+    if (depth > MTRACE_BT_MAX_DEPTH)
+        depth = MTRACE_BT_MAX_DEPTH;
+
+    hash = hash_stack(bt, depth);
+    for (i = 0; table && i < STACK_MAX_PROBES; i++) {
+        struct stack_entry *entry = &table[(hash + i) & (STACK_TABLE_SIZE - 1)];
+        int state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+
+        if (state == ENTRY_EMPTY) {
+            if (!__atomic_compare_exchange_n(&entry->state, &state, ENTRY_BUSY,
+                    0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+                /* Another stack took the entry first: it may be this one */
+                i--;
+                continue;
+            }
+
+            memcpy(entry->frames, bt, depth * sizeof(void *));
+            entry->depth = depth;
+            entry->hash = hash;
+            entry->id = __atomic_add_fetch(&last_id, 1, __ATOMIC_RELAXED);
+            entry->gen = 0;
+            __atomic_store_n(&entry->state, ENTRY_READY, __ATOMIC_RELEASE);
+            if (entry->id <= STACK_TABLE_SIZE)
+                __atomic_store_n(&ID_TABLE(table)[entry->id], entry, __ATOMIC_RELEASE);
+
+            define_stack(entry, enabled, def);
+            return entry->id;
+        }
+
+        while (state == ENTRY_BUSY)
+            state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+
+        if (state == ENTRY_READY && entry->hash == hash && entry->depth == depth &&
+                memcmp(entry->frames, bt, depth * sizeof(void *)) == 0) {
+            define_stack(entry, enabled, def);
+            return entry->id;
+        }
+    }
+
+    /* No room for the stack: it gets the shared ID, defined without frames */
+    __atomic_add_fetch(&overflow_count, 1, __ATOMIC_RELAXED);
+    gen = __atomic_load_n(&def_gen, __ATOMIC_RELAXED);
+    if (enabled && __atomic_exchange_n(&overflow_gen, gen, __ATOMIC_RELAXED) != gen)
+        def->emit(MTRACE_STACK_OVERFLOW_ID, bt, 0);
+    return MTRACE_STACK_OVERFLOW_ID;
+}
+
+uint64_t mtrace_stack_overflows(void)
+{
+    return __atomic_load_n(&overflow_count, __ATOMIC_RELAXED);
+}
+
+void **mtrace_stack_get(uint32_t id, size_t *depth)
+{
+    struct stack_entry *table = __atomic_load_n(&stack_table, __ATOMIC_ACQUIRE);
+    struct stack_entry *entry;
+
+    if (!table || id == 0 || id > STACK_TABLE_SIZE)
+        return NULL;
+
+    entry = __atomic_load_n(&ID_TABLE(table)[id], __ATOMIC_ACQUIRE);
+    if (!entry)
+        return NULL;
+
+    *depth = entry->depth;
+    return entry->frames;
+}
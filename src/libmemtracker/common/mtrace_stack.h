@@ -0,0 +1,66 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _MTRACE_STACK_H
+#define _MTRACE_STACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Stack IDs.
+ *
+ * Allocation events record a 32-bit ID instead of their backtrace. The
+ * first time a backtrace is seen (and again whenever the "stack_def"
+ * event gets enabled), "emit" records a stack_def event mapping the ID
+ * to the frames. "enabled" tells whether stack_def is enabled.
+ */
+struct mtrace_stack_def {
+    int (*enabled)(void);
+    void (*emit)(uint32_t id, void **bt, size_t depth);
+};
+
+/* Stacks get the IDs 1 to MTRACE_STACK_MAX_ID, in the order they are seen */
+#define MTRACE_STACK_MAX_ID         16384
+
+/*
+ * ID shared by the stacks which find no room in the table. Its stack_def
+ * has no frames, and is recorded once per session.
+ */
+#define MTRACE_STACK_OVERFLOW_ID    UINT32_MAX
+
+uint32_t mtrace_stack_id(void **bt, size_t depth, const struct mtrace_stack_def *def)
+    __attribute__((visibility("hidden")));
+
+/* Number of times MTRACE_STACK_OVERFLOW_ID was returned */
+uint64_t mtrace_stack_overflows(void) __attribute__((visibility("hidden")));
+
+/*
+ * Frames of a stack ID, or NULL if the ID is unknown. Lock-free, and
+ * safe to call from a signal handler.
+ */
+void **mtrace_stack_get(uint32_t id, size_t *depth)
+    __attribute__((visibility("hidden")));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MTRACE_STACK_H */
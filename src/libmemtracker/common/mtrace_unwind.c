@@ -0,0 +1,127 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mtrace_unwind.h"
+
+int mtrace_unwinder = MTRACE_UNWIND_BACKTRACE;
+size_t mtrace_bt_depth = MTRACE_BT_DEFAULT_DEPTH;
+
+/* Frame record pointed to by the frame pointer on x86 and AArch64 */
+struct frame_record {
+    struct frame_record *next;
+    void *ret;
+};
+
+/* Upper end of the stack of the thread, looked up on the first walk */
+static __thread uintptr_t stack_top;
+
+static
+uintptr_t get_stack_top(void)
+{
+    pthread_attr_t attr;
+    void *addr;
+    size_t size;
+
+    if (stack_top)
+        return stack_top;
+
+    if (pthread_getattr_np(pthread_self(), &attr) != 0)
+        return 0;
+    if (pthread_attr_getstack(&attr, &addr, &size) == 0)
+        stack_top = (uintptr_t)addr + size;
+    pthread_attr_destroy(&attr);
+    return stack_top;
+}
+
+size_t mtrace_unwind_fp(void **bt, size_t depth, void *frame)
+{
+    struct frame_record *fr = frame;
+    uintptr_t top = get_stack_top();
+    size_t n = 0;
+
+    if (!top)
+        return 0;
+
+    /*
+     * Frames must go up the stack of the thread, so a code without frame
+     * pointers stops the walk instead of sending it out of the stack.
+     */
+    while (n < depth) {
+        struct frame_record *next;
+
+        if ((uintptr_t)fr < (uintptr_t)frame ||
+                (uintptr_t)(fr + 1) > top ||
+                ((uintptr_t)fr & (sizeof(void *) - 1)))
+            break;
+        if (!fr->ret)
+            break;
+        bt[n++] = fr->ret;
+
+        next = fr->next;
+        if (next <= fr)
+            break;
+        fr = next;
+    }
+    return n;
+}
+
+void mtrace_unwind_init(void)
+{
+    const char *env = getenv("MTRACE_UNWINDER");
+
+    if (env) {
+        if (strcmp(env, "backtrace") == 0) {
+            mtrace_unwinder = MTRACE_UNWIND_BACKTRACE;
+        } else if (strcmp(env, "caller") == 0) {
+            mtrace_unwinder = MTRACE_UNWIND_CALLER;
+        } else if (strcmp(env, "fp") == 0) {
+#ifdef MTRACE_HAVE_FP_UNWIND
+            mtrace_unwinder = MTRACE_UNWIND_FP;
+#else
+            fprintf(stderr, "mtrace: no frame pointer unwinder on this target, "
+                "using backtrace\n");
+#endif
+        } else {
+            fprintf(stderr, "mtrace: unknown MTRACE_UNWINDER \"%s\"\n", env);
+        }
+    }
+
+    env = getenv("MTRACE_BT_DEPTH");
+    if (env) {
+        long depth = strtol(env, NULL, 10);
+
+        if (depth < 1)
+            depth = 1;
+        if (depth > MTRACE_BT_MAX_DEPTH)
+            depth = MTRACE_BT_MAX_DEPTH;
+        mtrace_bt_depth = depth;
+    }
+
+    /* The first backtrace() loads libgcc_s: do it now, not in a wrapper */
+    if (mtrace_unwinder == MTRACE_UNWIND_BACKTRACE) {
+        void *bt[2];
+
+        backtrace(bt, 2);
+    }
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _MTRACE_UNWIND_H
+#define _MTRACE_UNWIND_H
+
+#include <execinfo.h>
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Stack capture of the allocation wrappers.
+ *
+ * MTRACE_UNWINDER selects the unwinder at preload time:
+ *   backtrace : glibc backtrace() (default)
+ *   fp        : walk the frame pointer chain (x86 and AArch64). Much
+ *               cheaper, but code built without frame pointers ends the
+ *               walk early.
+ *   caller    : only the immediate caller
+ * MTRACE_BT_DEPTH sets the number of frames (default 5, at most 32).
+ */
+#define MTRACE_BT_DEFAULT_DEPTH 5
+#define MTRACE_BT_MAX_DEPTH 32
+
+/* bt[0] is unused, so callers record "bt + 1, depth - 1" */
+#define MTRACE_BT_ARRAY_SIZE (MTRACE_BT_MAX_DEPTH + 1)
+
+#define MTRACE_UNWIND_BACKTRACE 0
+#define MTRACE_UNWIND_FP        1
+#define MTRACE_UNWIND_CALLER    2
+
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+#define MTRACE_HAVE_FP_UNWIND 1
+#endif
+
+extern int mtrace_unwinder __attribute__((visibility("hidden")));
+extern size_t mtrace_bt_depth __attribute__((visibility("hidden")));
+
+void mtrace_unwind_init(void) __attribute__((visibility("hidden")));
+
+size_t mtrace_unwind_fp(void **bt, size_t depth, void *frame)
+    __attribute__((visibility("hidden")));
+
+/*
+ * Fill bt[1..] with the return addresses of the caller of the wrapper
+ * and its callers, and return the number of entries including bt[0].
+ * Always inlined, so that frame 0 is the wrapper itself.
+ */
+static inline __attribute__((always_inline))
+size_t mtrace_unwind(void **bt)
+{
+    size_t depth;
+
+    switch (mtrace_unwinder) {
+    case MTRACE_UNWIND_FP:
+        bt[0] = NULL;
+        return mtrace_unwind_fp(bt + 1, mtrace_bt_depth, __builtin_frame_address(0)) + 1;
+    case MTRACE_UNWIND_CALLER:
+        bt[0] = NULL;
+        bt[1] = __builtin_return_address(0);
+        return 2;
+    default:
+        depth = backtrace(bt, mtrace_bt_depth + 1);
+        return depth > 0 ? depth : 1;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MTRACE_UNWIND_H */
@@ -20,16 +20,21 @@
 #define _GNU_SOURCE
 
 #include <assert.h>
-#include <execinfo.h>
+#include <malloc.h>
+#include <stdint.h>
+#include <sys/mman.h>
 #include <sys/types.h>
 
 #define TRACEPOINT_DEFINE
 #define TRACEPOINT_CREATE_PROBES
 #define TP_IP_PARAM ip
 #include "ust_mtrace_malloc.h"
-
-#define MAX_BT_DEPTH 5
-#define BT_ARRAY_SIZE MAX_BT_DEPTH+1
+#include "mtrace_unwind.h"
+#include "mtrace_stack.h"
+#include "mtrace_heap.h"
+#include "mtrace_sample.h"
+#include "mtrace_batch.h"
+#include "mtrace_malloc.h"
 
 /*
     lttng/align.h
@@ -57,9 +62,24 @@ extern void *dlsym(void *__restrict __handle,
 extern char *dlerror(void);
 
 
-#define STATIC_CALLOC_LEN 4096
-static char static_calloc_buf[STATIC_CALLOC_LEN];
-static unsigned long static_calloc_buf_offset;
+/*
+ * Bootstrap arena of the static allocator. Its address range is reserved
+ * on first use without access rights, and made accessible chunk by chunk
+ * as it fills, so that it can grow in place and a single compare tells
+ * whether a pointer belongs to it. Until it is reserved, the base points
+ * to the top of the address space, where no user pointer lies.
+ */
+#define BOOTSTRAP_RESERVE (64UL << 20)
+#define BOOTSTRAP_CHUNK (64UL << 10)
+#define BOOTSTRAP_UNSET ((uintptr_t)-BOOTSTRAP_RESERVE)
+
+static uintptr_t bootstrap_base = BOOTSTRAP_UNSET;
+static unsigned long bootstrap_offset;
+static unsigned long bootstrap_committed;
+
+#define IS_BOOTSTRAP(ptr) \
+    caa_unlikely((uintptr_t)(ptr) - CMM_LOAD_SHARED(bootstrap_base) < \
+        BOOTSTRAP_RESERVE)
 
 struct alloc_functions {
     void *(*calloc)(size_t nmemb, size_t size);
@@ -70,15 +90,134 @@ struct alloc_functions {
     int (*posix_memalign)(void **memptr, size_t alignment, size_t size);
 };
 
-static
-void *static_calloc(size_t nmemb, size_t size);
+static void *lazy_calloc(size_t nmemb, size_t size);
+static void *lazy_malloc(size_t size);
+static void lazy_free(void *ptr);
+static void *lazy_realloc(void *ptr, size_t size);
+static void *lazy_memalign(size_t alignment, size_t size);
+static int lazy_posix_memalign(void **memptr, size_t alignment, size_t size);
 
+/*
+ * The allocator functions start as the lazy_* ones, which resolve them
+ * all on the first call, so that the wrappers call through cur_alloc
+ * without checking it.
+ */
 static
 struct alloc_functions cur_alloc = {
-    .calloc = static_calloc
+    .calloc = lazy_calloc,
+    .malloc = lazy_malloc,
+    .free = lazy_free,
+    .realloc = lazy_realloc,
+    .memalign = lazy_memalign,
+    .posix_memalign = lazy_posix_memalign
+};
+
+/* State of the symbol resolution */
+enum {
+    ALLOC_UNRESOLVED,
+    ALLOC_RESOLVING,
+    ALLOC_RESOLVED,
 };
 
-static __thread int malloc_nesting = 0;
+static int alloc_state = ALLOC_UNRESOLVED;
+
+__thread int malloc_nesting = 0;
+
+static
+int stack_def_enabled(void)
+{
+    return tracepoint_enabled(mtrace_malloc, stack_def);
+}
+
+static
+void stack_def_emit(uint32_t id, void **bt, size_t depth)
+{
+    do_tracepoint(mtrace_malloc, stack_def, id, bt, depth);
+}
+
+const struct mtrace_stack_def mtrace_malloc_stack_def = {
+    stack_def_enabled,
+    stack_def_emit
+};
+
+static
+int alloc_batch_enabled(void)
+{
+    return tracepoint_enabled(mtrace_malloc, alloc_batch);
+}
+
+static
+void alloc_batch_emit(pid_t tid, const void *recs, size_t len)
+{
+    do_tracepoint(mtrace_malloc, alloc_batch, tid, recs, len);
+}
+
+const struct mtrace_batch_def mtrace_malloc_batch_def = {
+    alloc_batch_enabled,
+    alloc_batch_emit
+};
+
+/* Append a record to the batch of the thread. False if not batched. */
+#define BATCH(op, ptr, size, arg, weight, stack_id) \
+    (mtrace_batch_size && mtrace_batch_add(&mtrace_malloc_batch_def, \
+        op, ptr, size, (uint64_t)(arg), weight, stack_id))
+
+/* A macro, so that the unwinder starts from the wrapper */
+#define GET_STACK_ID(bt) \
+    mtrace_stack_id((bt) + 1, mtrace_unwind(bt) - 1, \
+        &mtrace_malloc_stack_def)
+
+static
+uintptr_t bootstrap_reserve(void)
+{
+    uintptr_t base = CMM_LOAD_SHARED(bootstrap_base);
+    uintptr_t prev;
+    void *map;
+
+    if (base != BOOTSTRAP_UNSET)
+        return base;
+
+    map = mmap(NULL, BOOTSTRAP_RESERVE, PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "static_calloc_aligned: Cannot reserve bootstrap arena\n");
+        abort();
+    }
+
+    /* Another thread may have been first */
+    prev = uatomic_cmpxchg(&bootstrap_base, BOOTSTRAP_UNSET, (uintptr_t)map);
+    if (prev != BOOTSTRAP_UNSET) {
+        munmap(map, BOOTSTRAP_RESERVE);
+        return prev;
+    }
+    return (uintptr_t)map;
+}
+
+/* Make the arena accessible up to "end" */
+static
+void bootstrap_commit(uintptr_t base, unsigned long end)
+{
+    unsigned long committed = CMM_LOAD_SHARED(bootstrap_committed);
+    unsigned long target, prev;
+
+    if (end <= committed)
+        return;
+
+    /* Racing threads may protect the same pages, which is harmless */
+    target = ALIGN(end, BOOTSTRAP_CHUNK);
+    if (mprotect((void *)(base + committed), target - committed,
+            PROT_READ | PROT_WRITE) != 0) {
+        fprintf(stderr, "static_calloc_aligned: Cannot grow bootstrap arena\n");
+        abort();
+    }
+
+    while (committed < target) {
+        prev = uatomic_cmpxchg(&bootstrap_committed, committed, target);
+        if (prev == committed)
+            break;
+        committed = prev;
+    }
+}
 
 /*
  * Static allocator to use when initially executing dlsym(). It keeps a
@@ -88,30 +227,35 @@ static
 void *static_calloc_aligned(size_t nmemb, size_t size, size_t alignment)
 {
     size_t prev_offset, new_offset, res_offset, aligned_offset;
+    uintptr_t base;
 
     if (nmemb * size == 0) {
         return NULL;
     }
 
+    base = bootstrap_reserve();
+
     /*
-     * Protect static_calloc_buf_offset from concurrent updates
+     * Protect bootstrap_offset from concurrent updates
      * using a cmpxchg loop rather than a mutex to remove a
      * dependency on pthread. This will minimize the risk of bad
      * interaction between mutex and malloc instrumentation.
      */
-    res_offset = CMM_LOAD_SHARED(static_calloc_buf_offset);
+    res_offset = CMM_LOAD_SHARED(bootstrap_offset);
     do {
         prev_offset = res_offset;
         aligned_offset = ALIGN(prev_offset + sizeof(size_t), alignment);
         new_offset = aligned_offset + nmemb * size;
-        if (new_offset > sizeof(static_calloc_buf)) {
-            fprintf(stderr, "static_calloc_aligned: Exceed local buffer\n");
+        if (new_offset > BOOTSTRAP_RESERVE || new_offset < aligned_offset) {
+            fprintf(stderr, "static_calloc_aligned: Exceed bootstrap arena\n");
             abort();
         }
-    } while ((res_offset = uatomic_cmpxchg(&static_calloc_buf_offset,
+    } while ((res_offset = uatomic_cmpxchg(&bootstrap_offset,
             prev_offset, new_offset)) != prev_offset);
-    *(size_t *) &static_calloc_buf[aligned_offset - sizeof(size_t)] = size;
-    return &static_calloc_buf[aligned_offset];
+
+    bootstrap_commit(base, new_offset);
+    *(size_t *) (base + aligned_offset - sizeof(size_t)) = size;
+    return (void *) (base + aligned_offset);
 }
 
 static
@@ -138,32 +282,28 @@ void static_free(void *ptr)
     /* no-op. */
 }
 
+/*
+ * realloc() handles the bootstrap blocks itself, so "ptr" is a block of
+ * the next allocator, allocated before another thread started resolving
+ * the symbols. Its header is not ours: copy it to a bootstrap block, and
+ * leak it.
+ */
 static
 void *static_realloc(void *ptr, size_t size)
 {
-    size_t *old_size = NULL;
+    size_t old_size;
     void *retval;
 
-    if (size == 0) {
-        retval = NULL;
-        goto end;
-    }
+    if (size == 0)
+        return NULL;
 
-    if (ptr) {
-        old_size = (size_t *) ptr - 1;
-        if (size <= *old_size) {
-            /* We can re-use the old entry. */
-            *old_size = size;
-            retval = ptr;
-            goto end;
-        }
-    }
     /* We need to expand. Don't free previous memory location. */
     retval = static_calloc_aligned(1, size, 1);
     assert(retval);
-    if (ptr)
-        memcpy(retval, ptr, *old_size);
-end:
+    if (ptr) {
+        old_size = malloc_usable_size(ptr);
+        memcpy(retval, ptr, old_size < size ? old_size : size);
+    }
     return retval;
 }
 
@@ -197,18 +337,24 @@ end:
 static
 void setup_static_allocator(void)
 {
-    assert(cur_alloc.calloc == NULL);
-    cur_alloc.calloc = static_calloc;
-    assert(cur_alloc.malloc == NULL);
-    cur_alloc.malloc = static_malloc;
-    assert(cur_alloc.free == NULL);
-    cur_alloc.free = static_free;
-    assert(cur_alloc.realloc == NULL);
-    cur_alloc.realloc = static_realloc;
-    assert(cur_alloc.memalign == NULL);
-    cur_alloc.memalign = static_memalign;
-    assert(cur_alloc.posix_memalign == NULL);
-    cur_alloc.posix_memalign = static_posix_memalign;
+    CMM_STORE_SHARED(cur_alloc.calloc, static_calloc);
+    CMM_STORE_SHARED(cur_alloc.malloc, static_malloc);
+    CMM_STORE_SHARED(cur_alloc.free, static_free);
+    CMM_STORE_SHARED(cur_alloc.realloc, static_realloc);
+    CMM_STORE_SHARED(cur_alloc.memalign, static_memalign);
+    CMM_STORE_SHARED(cur_alloc.posix_memalign, static_posix_memalign);
+}
+
+static
+void *lookup_symbol(const char *name)
+{
+    void *sym = dlsym(RTLD_NEXT, name);
+
+    if (sym == NULL) {
+        fprintf(stderr, "mtrace-malloc: unable to find %s\n", name);
+        abort();
+    }
+    return sym;
 }
 
 static
@@ -224,36 +370,112 @@ void lookup_all_symbols(void)
     setup_static_allocator();
 
     /* Perform the actual lookups */
-    af.calloc = dlsym(RTLD_NEXT, "calloc");
-    af.malloc = dlsym(RTLD_NEXT, "malloc");
-    af.free = dlsym(RTLD_NEXT, "free");
-    af.realloc = dlsym(RTLD_NEXT, "realloc");
-    af.memalign = dlsym(RTLD_NEXT, "memalign");
-    af.posix_memalign = dlsym(RTLD_NEXT, "posix_memalign");
+    af.calloc = lookup_symbol("calloc");
+    af.malloc = lookup_symbol("malloc");
+    af.free = lookup_symbol("free");
+    af.realloc = lookup_symbol("realloc");
+    af.memalign = lookup_symbol("memalign");
+    af.posix_memalign = lookup_symbol("posix_memalign");
+
+    /* Populate the new allocator functions, one pointer at a time */
+    CMM_STORE_SHARED(cur_alloc.calloc, af.calloc);
+    CMM_STORE_SHARED(cur_alloc.malloc, af.malloc);
+    CMM_STORE_SHARED(cur_alloc.free, af.free);
+    CMM_STORE_SHARED(cur_alloc.realloc, af.realloc);
+    CMM_STORE_SHARED(cur_alloc.memalign, af.memalign);
+    CMM_STORE_SHARED(cur_alloc.posix_memalign, af.posix_memalign);
+}
 
-    /* Populate the new allocator functions */
-    memcpy(&cur_alloc, &af, sizeof(cur_alloc));
+/*
+ * Resolve the symbols once. Return 0 if another thread is resolving
+ * them, in which case the caller is served by the static allocator:
+ * waiting could deadlock, if that thread needs a lock the caller holds.
+ */
+static
+int resolve_symbols(void)
+{
+    if (uatomic_cmpxchg(&alloc_state, ALLOC_UNRESOLVED, ALLOC_RESOLVING)
+            != ALLOC_UNRESOLVED)
+        return CMM_LOAD_SHARED(alloc_state) == ALLOC_RESOLVED;
+
+    lookup_all_symbols();
+    cmm_smp_mb();
+    CMM_STORE_SHARED(alloc_state, ALLOC_RESOLVED);
+    return 1;
+}
+
+static
+void *lazy_calloc(size_t nmemb, size_t size)
+{
+    if (!resolve_symbols())
+        return static_calloc(nmemb, size);
+    return cur_alloc.calloc(nmemb, size);
+}
+
+static
+void *lazy_malloc(size_t size)
+{
+    if (!resolve_symbols())
+        return static_malloc(size);
+    return cur_alloc.malloc(size);
+}
+
+/* A block freed while another thread resolves the symbols is leaked */
+static
+void lazy_free(void *ptr)
+{
+    if (!resolve_symbols())
+        return;
+    cur_alloc.free(ptr);
+}
+
+static
+void *lazy_realloc(void *ptr, size_t size)
+{
+    if (!resolve_symbols())
+        return static_realloc(ptr, size);
+    return cur_alloc.realloc(ptr, size);
+}
+
+static
+void *lazy_memalign(size_t alignment, size_t size)
+{
+    if (!resolve_symbols())
+        return static_memalign(alignment, size);
+    return cur_alloc.memalign(alignment, size);
+}
+
+static
+int lazy_posix_memalign(void **memptr, size_t alignment, size_t size)
+{
+    if (!resolve_symbols())
+        return static_posix_memalign(memptr, alignment, size);
+    return cur_alloc.posix_memalign(memptr, alignment, size);
 }
 
 void *malloc(size_t size)
 {
     void *retval;
-    void *bt[BT_ARRAY_SIZE];
-    size_t depth;
+    void *bt[MTRACE_BT_ARRAY_SIZE];
 
     malloc_nesting++;
-    if (cur_alloc.malloc == NULL) {
-        cur_alloc.malloc = dlsym(RTLD_NEXT, "malloc");
-        cur_alloc.calloc = dlsym(RTLD_NEXT, "calloc");
-    }
     retval = cur_alloc.malloc(size);
     if (malloc_nesting == 1) {
-        if (tracepoint_enabled(mtrace_malloc, malloc)) {
-            depth = backtrace(bt, BT_ARRAY_SIZE);
-
-            do_tracepoint(mtrace_malloc, malloc,
-            size, retval, __builtin_return_address(0),
-            bt+1, depth-1);
+        int traced = tracepoint_enabled(mtrace_malloc, malloc);
+        uint64_t weight;
+
+        if ((traced || mtrace_heap_mode) && mtrace_sample(size, &weight)) {
+            uint32_t stack_id = GET_STACK_ID(bt);
+
+            if (mtrace_heap_mode)
+                mtrace_heap_alloc(retval, weight, stack_id);
+            else if (traced && mtrace_sample_interval)
+                mtrace_sample_track(retval, weight);
+            if (traced && !BATCH(MTRACE_OP_MALLOC, retval, size, 0,
+                    weight, stack_id))
+                do_tracepoint(mtrace_malloc, malloc,
+                    size, retval, __builtin_return_address(0),
+                    stack_id, weight);
         }
     }
 end:
@@ -261,6 +483,25 @@ end:
     return retval;
 }
 
+/*
+ * Forget a block before its release. Returns whether the release is to
+ * be traced: with sampling, only if the allocation of the block was.
+ * "weight" is set to the weight of the block when it is known.
+ */
+static
+int release_block(void *ptr, uint64_t *weight)
+{
+    struct mtrace_heap_block block;
+
+    if (mtrace_heap_mode && mtrace_heap_free(ptr, &block)) {
+        *weight = block.size;
+        return 1;
+    }
+    if (mtrace_sample_interval)
+        return !mtrace_heap_mode && mtrace_sample_untrack(ptr, weight);
+    return 1;
+}
+
 void free(void *ptr)
 {
     malloc_nesting++;
@@ -268,25 +509,21 @@ void free(void *ptr)
      * Check whether the memory was allocated with
      * static_calloc_align, in which case there is nothing to free.
      */
-    if (caa_unlikely((char *)ptr >= static_calloc_buf &&
-            (char *)ptr < static_calloc_buf + STATIC_CALLOC_LEN)) {
+    if (IS_BOOTSTRAP(ptr)) {
         goto end;
     }
 
     if (malloc_nesting == 1) {
-        if (tracepoint_enabled(mtrace_malloc, free)) {
+        uint64_t weight = 0;
+
+        if (release_block(ptr, &weight) &&
+                tracepoint_enabled(mtrace_malloc, free) &&
+                !BATCH(MTRACE_OP_FREE, ptr, 0, 0, weight, 0)) {
             do_tracepoint(mtrace_malloc, free,
                 ptr, __builtin_return_address(0));
         }
     }
 
-    if (cur_alloc.free == NULL) {
-        cur_alloc.free = dlsym(RTLD_NEXT, "free");
-        if (cur_alloc.free == NULL) {
-            fprintf(stderr, "freewrap: unable to find free\n");
-            abort();
-        }
-    }
     cur_alloc.free(ptr);
 end:
     malloc_nesting--;
@@ -295,24 +532,26 @@ end:
 void *calloc(size_t nmemb, size_t size)
 {
     void *retval;
-    void *bt[BT_ARRAY_SIZE];
-    size_t depth;
+    void *bt[MTRACE_BT_ARRAY_SIZE];
 
     malloc_nesting++;
-    if (cur_alloc.calloc == NULL) {
-        cur_alloc.calloc = dlsym(RTLD_NEXT, "calloc");
-        if (cur_alloc.calloc == NULL) {
-            fprintf(stderr, "callocwrap: unable to find calloc\n");
-            abort();
-        }
-    }
     retval = cur_alloc.calloc(nmemb, size);
     if (malloc_nesting == 1) {
-        depth = backtrace(bt, BT_ARRAY_SIZE);   // Exception to avoid deadlock
-        if (tracepoint_enabled(mtrace_malloc, calloc)) {
-            do_tracepoint(mtrace_malloc, calloc,
-                nmemb, size, retval, __builtin_return_address(0),
-                bt+1, depth-1);
+        int traced = tracepoint_enabled(mtrace_malloc, calloc);
+        uint64_t weight;
+
+        if ((traced || mtrace_heap_mode) && mtrace_sample(nmemb * size, &weight)) {
+            uint32_t stack_id = GET_STACK_ID(bt);
+
+            if (mtrace_heap_mode)
+                mtrace_heap_alloc(retval, weight, stack_id);
+            else if (traced && mtrace_sample_interval)
+                mtrace_sample_track(retval, weight);
+            if (traced && !BATCH(MTRACE_OP_CALLOC, retval, nmemb * size,
+                    nmemb, weight, stack_id))
+                do_tracepoint(mtrace_malloc, calloc,
+                    nmemb, size, retval, __builtin_return_address(0),
+                    stack_id, weight);
         }
     }
 end:
@@ -323,38 +562,59 @@ end:
 void *realloc(void *ptr, size_t size)
 {
     void *retval;
-    void *bt[BT_ARRAY_SIZE];
-    size_t depth;
+    void *bt[MTRACE_BT_ARRAY_SIZE];
+    struct mtrace_heap_block old_block;
+    uint64_t old_weight = 0;
+    int known = 0;
 
     malloc_nesting++;
-    if (caa_unlikely((char *)ptr >= static_calloc_buf &&
-            (char *)ptr < static_calloc_buf + STATIC_CALLOC_LEN)) {
+    if (IS_BOOTSTRAP(ptr)) {
         size_t *old_size;
 
         old_size = (size_t *) ptr - 1;
         retval = cur_alloc.calloc(1, size);
         if (retval) {
-            memcpy(retval, ptr, *old_size);
+            memcpy(retval, ptr, *old_size < size ? *old_size : size);
         }
         ptr = NULL;
         goto end;
     }
 
-    if (cur_alloc.realloc == NULL) {
-        cur_alloc.realloc = dlsym(RTLD_NEXT, "realloc");
-        if (cur_alloc.realloc == NULL) {
-            fprintf(stderr, "reallocwrap: unable to find realloc\n");
-            abort();
-        }
-    }
+    /* Forget the block first, as realloc() may free it */
+    if (malloc_nesting == 1 && mtrace_heap_mode)
+        known = mtrace_heap_free(ptr, &old_block);
+    else if (malloc_nesting == 1 && mtrace_sample_interval)
+        known = mtrace_sample_untrack(ptr, &old_weight);
     retval = cur_alloc.realloc(ptr, size);
+    if (known && retval == NULL && size != 0) {
+        if (mtrace_heap_mode)
+            mtrace_heap_alloc(ptr, old_block.size, old_block.stack_id);
+        else
+            mtrace_sample_track(ptr, old_weight);
+    }
 end:
     if (malloc_nesting == 1) {
-        if (tracepoint_enabled(mtrace_malloc, realloc)) {
-            depth = backtrace(bt, BT_ARRAY_SIZE);
+        int traced = tracepoint_enabled(mtrace_malloc, realloc);
+        uint64_t weight = 0;
+
+        if ((traced || mtrace_heap_mode) && mtrace_sample(size, &weight)) {
+            uint32_t stack_id = GET_STACK_ID(bt);
+
+            if (mtrace_heap_mode)
+                mtrace_heap_alloc(retval, weight, stack_id);
+            else if (traced && mtrace_sample_interval)
+                mtrace_sample_track(retval, weight);
+            if (traced && !BATCH(MTRACE_OP_REALLOC, retval, size,
+                    (uintptr_t)ptr, weight, stack_id))
+                do_tracepoint(mtrace_malloc, realloc,
+                    ptr, size, retval, __builtin_return_address(0),
+                    stack_id, weight);
+        } else if (traced && ptr && (known || !mtrace_sample_interval) &&
+                !BATCH(MTRACE_OP_REALLOC, retval, size, (uintptr_t)ptr, 0, 0)) {
+            /* Not sampled, but the release of "ptr" must be seen */
             do_tracepoint(mtrace_malloc, realloc,
                 ptr, size, retval, __builtin_return_address(0),
-                bt+1, depth-1);
+                0, 0);
         }
     }
     malloc_nesting--;
@@ -364,25 +624,27 @@ end:
 void *memalign(size_t alignment, size_t size)
 {
     void *retval;
-    void *bt[BT_ARRAY_SIZE];
-    size_t depth;
+    void *bt[MTRACE_BT_ARRAY_SIZE];
 
     malloc_nesting++;
-    if (cur_alloc.memalign == NULL) {
-        cur_alloc.memalign = dlsym(RTLD_NEXT, "memalign");
-        if (cur_alloc.memalign == NULL) {
-            fprintf(stderr, "memalignwrap: unable to find memalign\n");
-            abort();
-        }
-    }
     retval = cur_alloc.memalign(alignment, size);
     if (malloc_nesting == 1) {
-        if (tracepoint_enabled(mtrace_malloc, memalign)) {
-            depth = backtrace(bt, BT_ARRAY_SIZE);
-            do_tracepoint(mtrace_malloc, memalign,
-                alignment, size, retval,
-                __builtin_return_address(0),
-                bt+1, depth-1);
+        int traced = tracepoint_enabled(mtrace_malloc, memalign);
+        uint64_t weight;
+
+        if ((traced || mtrace_heap_mode) && mtrace_sample(size, &weight)) {
+            uint32_t stack_id = GET_STACK_ID(bt);
+
+            if (mtrace_heap_mode)
+                mtrace_heap_alloc(retval, weight, stack_id);
+            else if (traced && mtrace_sample_interval)
+                mtrace_sample_track(retval, weight);
+            if (traced && !BATCH(MTRACE_OP_MEMALIGN, retval, size,
+                    alignment, weight, stack_id))
+                do_tracepoint(mtrace_malloc, memalign,
+                    alignment, size, retval,
+                    __builtin_return_address(0),
+                    stack_id, weight);
         }
     }
     malloc_nesting--;
@@ -392,49 +654,68 @@ void *memalign(size_t alignment, size_t size)
 int posix_memalign(void **memptr, size_t alignment, size_t size)
 {
     int retval;
-    void *bt[BT_ARRAY_SIZE];
-    size_t depth;
+    void *bt[MTRACE_BT_ARRAY_SIZE];
 
     malloc_nesting++;
-    if (cur_alloc.posix_memalign == NULL) {
-        cur_alloc.posix_memalign = dlsym(RTLD_NEXT, "posix_memalign");
-        if (cur_alloc.posix_memalign == NULL) {
-            fprintf(stderr, "posix_memalignwrap: unable to find posix_memalign\n");
-            abort();
-        }
-    }
     retval = cur_alloc.posix_memalign(memptr, alignment, size);
     if (malloc_nesting == 1) {
-        if (tracepoint_enabled(mtrace_malloc, posix_memalign)) {
-            depth = backtrace(bt, BT_ARRAY_SIZE);
-            do_tracepoint(mtrace_malloc, posix_memalign,
-                *memptr, alignment, size,
-                retval, __builtin_return_address(0),
-                bt+1, depth-1);
+        int traced = tracepoint_enabled(mtrace_malloc, posix_memalign);
+        uint64_t weight;
+
+        if ((traced || mtrace_heap_mode) && mtrace_sample(size, &weight)) {
+            uint32_t stack_id = GET_STACK_ID(bt);
+
+            if (mtrace_heap_mode && retval == 0)
+                mtrace_heap_alloc(*memptr, weight, stack_id);
+            else if (traced && mtrace_sample_interval && retval == 0)
+                mtrace_sample_track(*memptr, weight);
+            if (traced && !BATCH(MTRACE_OP_POSIX_MEMALIGN,
+                    retval == 0 ? *memptr : NULL, size,
+                    alignment, weight, stack_id))
+                do_tracepoint(mtrace_malloc, posix_memalign,
+                    *memptr, alignment, size,
+                    retval, __builtin_return_address(0),
+                    stack_id, weight);
         }
     }
     malloc_nesting--;
     return retval;
 }
 
+/*
+ * Test hook of bench/bootstrap_stress.c, not declared in any header.
+ * While held, the allocations are served as while another thread
+ * resolves the symbols, from the bootstrap arena. Releasing resolves
+ * them again.
+ */
+void mtrace_bootstrap_hold(int hold)
+{
+    if (hold) {
+        resolve_symbols();
+        CMM_STORE_SHARED(alloc_state, ALLOC_RESOLVING);
+        setup_static_allocator();
+    } else if (CMM_LOAD_SHARED(alloc_state) == ALLOC_RESOLVING) {
+        lookup_all_symbols();
+        cmm_smp_mb();
+        CMM_STORE_SHARED(alloc_state, ALLOC_RESOLVED);
+    }
+}
+
 __attribute__((constructor))
 void lttng_ust_malloc_wrapper_init(void)
 {
-    if (cur_alloc.calloc == NULL)
-        cur_alloc.calloc = dlsym(RTLD_NEXT, "calloc");
-
-    if (cur_alloc.malloc == NULL)
-        cur_alloc.malloc = dlsym(RTLD_NEXT, "malloc");
-
-    if (cur_alloc.free == NULL)
-        cur_alloc.free = dlsym(RTLD_NEXT, "free");
-
-    if (cur_alloc.realloc = NULL)
-        cur_alloc.realloc = dlsym(RTLD_NEXT, "realloc");
+    /* Usually done already, by an allocation of the loader or of libc */
+    resolve_symbols();
 
-    if (cur_alloc.memalign == NULL)
-        cur_alloc.memalign = dlsym(RTLD_NEXT, "memalign");
+    /*
+     * The unwinder may load libraries on its first use. Do it here with
+     * the guard held, so that their allocations are not traced.
+     */
+    malloc_nesting++;
+    mtrace_unwind_init();
+    malloc_nesting--;
 
-    if (cur_alloc.posix_memalign == NULL)
-        cur_alloc.posix_memalign = dlsym(RTLD_NEXT, "posix_memalign");
+    mtrace_sample_init();
+    mtrace_heap_init();
+    mtrace_batch_init();
 }
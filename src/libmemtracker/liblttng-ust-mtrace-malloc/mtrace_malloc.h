@@ -0,0 +1,49 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _MTRACE_MALLOC_H
+#define _MTRACE_MALLOC_H
+
+#include "mtrace_stack.h"
+#include "mtrace_batch.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * State of the malloc wrapper shared with the C++ operators when both
+ * are built into libmemtracker.
+ *
+ * malloc_nesting is the reentrancy guard: the wrappers only record when
+ * they are not called from another wrapper. The operators allocate with
+ * the wrappers while holding it, so each allocation is recorded once.
+ * The stack IDs of both are defined by mtrace_malloc:stack_def, and
+ * their batches are recorded as mtrace_malloc:alloc_batch.
+ */
+extern __thread int malloc_nesting __attribute__((visibility("hidden")));
+
+extern const struct mtrace_stack_def mtrace_malloc_stack_def
+    __attribute__((visibility("hidden")));
+
+extern const struct mtrace_batch_def mtrace_malloc_batch_def
+    __attribute__((visibility("hidden")));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MTRACE_MALLOC_H */
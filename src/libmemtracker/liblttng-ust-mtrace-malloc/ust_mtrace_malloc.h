@@ -33,12 +33,32 @@ extern "C" {
 
 #include <lttng/tracepoint.h>
 
+/*
+ * Backtrace of a stack ID. Recorded the first time the stack is seen,
+ * and the allocation events refer to it by "stack_id".
+ */
+TRACEPOINT_EVENT(mtrace_malloc, stack_def,
+    TP_ARGS(uint32_t, id, void *, bt, size_t, depth),
+    TP_FIELDS(
+        ctf_integer(uint32_t, id, id)
+        ctf_sequence(void *, bt, bt, size_t, depth)
+    )
+)
+
+/*
+ * "weight" is the number of allocated bytes an allocation event stands
+ * for: its size, or the sampling weight with MTRACE_SAMPLE_BYTES. A
+ * realloc with a stack_id of 0 was not sampled and only releases "in_ptr".
+ * With sampling, only the blocks whose allocation was traced have their
+ * free, or the release by such a realloc, traced.
+ */
 TRACEPOINT_EVENT(mtrace_malloc, malloc,
-    TP_ARGS(size_t, size, void *, ptr, void *, ip, void *, bt, size_t, depth),
+    TP_ARGS(size_t, size, void *, ptr, void *, ip, uint32_t, stack_id, uint64_t, weight),
     TP_FIELDS(
         ctf_integer(size_t, size, size)
         ctf_integer_hex(void *, ptr, ptr)
-        ctf_sequence(void *, bt, bt, size_t, depth)
+        ctf_integer(uint32_t, stack_id, stack_id)
+        ctf_integer(uint64_t, weight, weight)
     )
 )
 
@@ -50,43 +70,59 @@ TRACEPOINT_EVENT(mtrace_malloc, free,
 )
 
 TRACEPOINT_EVENT(mtrace_malloc, calloc,
-    TP_ARGS(size_t, nmemb, size_t, size, void *, ptr, void *, ip, void *, bt, size_t, depth),
+    TP_ARGS(size_t, nmemb, size_t, size, void *, ptr, void *, ip, uint32_t, stack_id, uint64_t, weight),
     TP_FIELDS(
         ctf_integer(size_t, nmemb, nmemb)
         ctf_integer(size_t, size, size)
         ctf_integer_hex(void *, ptr, ptr)
-        ctf_sequence(void *, bt, bt, size_t, depth)
+        ctf_integer(uint32_t, stack_id, stack_id)
+        ctf_integer(uint64_t, weight, weight)
     )
 )
 
 TRACEPOINT_EVENT(mtrace_malloc, realloc,
-    TP_ARGS(void *, in_ptr, size_t, size, void *, ptr, void *, ip, void *, bt, size_t, depth),
+    TP_ARGS(void *, in_ptr, size_t, size, void *, ptr, void *, ip, uint32_t, stack_id, uint64_t, weight),
     TP_FIELDS(
         ctf_integer_hex(void *, in_ptr, in_ptr)
         ctf_integer(size_t, size, size)
         ctf_integer_hex(void *, ptr, ptr)
-        ctf_sequence(void *, bt, bt, size_t, depth)
+        ctf_integer(uint32_t, stack_id, stack_id)
+        ctf_integer(uint64_t, weight, weight)
     )
 )
 
 TRACEPOINT_EVENT(mtrace_malloc, memalign,
-    TP_ARGS(size_t, alignment, size_t, size, void *, ptr, void *, ip, void *, bt, size_t, depth),
+    TP_ARGS(size_t, alignment, size_t, size, void *, ptr, void *, ip, uint32_t, stack_id, uint64_t, weight),
     TP_FIELDS(
         ctf_integer(size_t, alignment, alignment)
         ctf_integer(size_t, size, size)
         ctf_integer_hex(void *, ptr, ptr)
-        ctf_sequence(void *, bt, bt, size_t, depth)
+        ctf_integer(uint32_t, stack_id, stack_id)
+        ctf_integer(uint64_t, weight, weight)
     )
 )
 
 TRACEPOINT_EVENT(mtrace_malloc, posix_memalign,
-    TP_ARGS(void *, out_ptr, size_t, alignment, size_t, size, int, result, void *, ip, void *, bt, size_t, depth),
+    TP_ARGS(void *, out_ptr, size_t, alignment, size_t, size, int, result, void *, ip, uint32_t, stack_id, uint64_t, weight),
     TP_FIELDS(
         ctf_integer_hex(void *, out_ptr, out_ptr)
         ctf_integer(size_t, alignment, alignment)
         ctf_integer(size_t, size, size)
         ctf_integer(int, result, result)
-        ctf_sequence(void *, bt, bt, size_t, depth)
+        ctf_integer(uint32_t, stack_id, stack_id)
+        ctf_integer(uint64_t, weight, weight)
+    )
+)
+
+/*
+ * Records of thread "tid" with MTRACE_BATCH: an array of
+ * struct mtrace_batch_rec (see mtrace_batch.h).
+ */
+TRACEPOINT_EVENT(mtrace_malloc, alloc_batch,
+    TP_ARGS(int, tid, const void *, records, size_t, len),
+    TP_FIELDS(
+        ctf_integer(int, tid, tid)
+        ctf_sequence_hex(uint8_t, records, (const uint8_t *)records, size_t, len)
     )
 )
 
@@ -15,16 +15,17 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <dlfcn.h>
-#include <execinfo.h>
 #include <sys/types.h>
+#include <new>
 
 #define TRACEPOINT_DEFINE
 #define TRACEPOINT_CREATE_PROBES
 #define TP_IP_PARAM ip
 #include "ust_mtrace_new.h"
-
-#define MAX_BT_DEPTH 5
-#define BT_ARRAY_SIZE MAX_BT_DEPTH+1
+#include "mtrace_unwind.h"
+#include "mtrace_stack.h"
+#include "mtrace_heap.h"
+#include "mtrace_batch.h"
 
 #define LOOKUP_FUNCTION(ptr, type, func) \
     if ((ptr) == NULL) { \
@@ -35,71 +36,372 @@
         } \
     }
 
+#ifdef MTRACE_COMBINED
+/*
+ * Built into libmemtracker with the malloc wrapper: allocate through it
+ * with its reentrancy guard held, and share its stack IDs.
+ */
+#include <stdlib.h>
+#include "mtrace_malloc.h"
+#include "mtrace_sample.h"
+
+#define new_nesting malloc_nesting
+#define STACK_DEF (&mtrace_malloc_stack_def)
+#define BATCH_DEF (&mtrace_malloc_batch_def)
+
+/* Sampled with the allocations of the malloc wrapper */
+#define SAMPLE(size, weight) mtrace_sample(size, weight)
+#define SAMPLING mtrace_sample_interval
+#define TRACK(ptr, weight) mtrace_sample_track(ptr, weight)
+#define UNTRACK(ptr, weight) mtrace_sample_untrack(ptr, weight)
+
+static void *real_malloc(size_t size) {
+    void *retval;
+
+    malloc_nesting++;
+    retval = malloc(size);
+    malloc_nesting--;
+    return retval;
+}
+
+static int real_posix_memalign(void **memptr, size_t alignment, size_t size) {
+    int retval;
+
+    malloc_nesting++;
+    retval = posix_memalign(memptr, alignment, size);
+    malloc_nesting--;
+    return retval;
+}
+
+static void real_free(void *ptr) {
+    malloc_nesting++;
+    free(ptr);
+    malloc_nesting--;
+}
+#else
 static struct alloc_functions {
     void *(*malloc)(size_t size);
     void (*free)(void *ptr);
+    int (*posix_memalign)(void **memptr, size_t alignment, size_t size);
 } cur_alloc;
 
+/* Set while recording, so that allocations made meanwhile are not */
+static __thread int new_nesting;
+
+static int stack_def_enabled(void) {
+    return tracepoint_enabled(mtrace_new, stack_def);
+}
+
+static void stack_def_emit(uint32_t id, void **bt, size_t depth) {
+    do_tracepoint(mtrace_new, stack_def, id, bt, depth);
+}
+
+static const struct mtrace_stack_def stack_def = {
+    stack_def_enabled,
+    stack_def_emit
+};
+
+#define STACK_DEF (&stack_def)
+
+static int alloc_batch_enabled(void) {
+    return tracepoint_enabled(mtrace_new, alloc_batch);
+}
+
+static void alloc_batch_emit(pid_t tid, const void *recs, size_t len) {
+    do_tracepoint(mtrace_new, alloc_batch, tid, recs, len);
+}
+
+static const struct mtrace_batch_def batch_def = {
+    alloc_batch_enabled,
+    alloc_batch_emit
+};
+
+#define BATCH_DEF (&batch_def)
+
+/* No sampling: every allocation stands for its own size */
+static inline int sample_all(size_t size, uint64_t *weight) {
+    *weight = size;
+    return 1;
+}
+
+#define SAMPLE(size, weight) sample_all(size, weight)
+#define SAMPLING 0
+#define TRACK(ptr, weight) do {} while (0)
+#define UNTRACK(ptr, weight) 0
+
+static void *real_malloc(size_t size) {
+    LOOKUP_FUNCTION(cur_alloc.malloc, void* (*)(size_t), malloc);
+    return cur_alloc.malloc(size);
+}
+
+static int real_posix_memalign(void **memptr, size_t alignment, size_t size) {
+    LOOKUP_FUNCTION(cur_alloc.posix_memalign,
+        int (*)(void **, size_t, size_t), posix_memalign);
+    return cur_alloc.posix_memalign(memptr, alignment, size);
+}
+
+static void real_free(void *ptr) {
+    LOOKUP_FUNCTION(cur_alloc.free, void (*)(void *), free);
+    cur_alloc.free(ptr);
+}
+
 void lookup_functions(void) {
     LOOKUP_FUNCTION(cur_alloc.malloc, void* (*)(size_t), malloc);
     LOOKUP_FUNCTION(cur_alloc.free, void (*)(void *), free);
+    LOOKUP_FUNCTION(cur_alloc.posix_memalign,
+        int (*)(void **, size_t, size_t), posix_memalign);
 }
+#endif /* MTRACE_COMBINED */
 
-void * operator new(size_t size) {
+#define GET_STACK_ID(bt) \
+    mtrace_stack_id((bt) + 1, mtrace_unwind(bt) - 1, STACK_DEF)
+
+/* Append a record to the batch of the thread. False if not batched. */
+#define BATCH(op, ptr, size, arg, weight, stack_id) \
+    (mtrace_batch_size && mtrace_batch_add(BATCH_DEF, \
+        op, ptr, size, arg, weight, stack_id))
+
+/*
+ * Record an allocation. A macro, so that the unwinder and the ip start
+ * from the operator. "align" goes to the batch record, and the extra
+ * arguments to the aligned events.
+ */
+#define RECORD_NEW(event, op, align, size, ptr, ...) \
+    do { \
+        int traced = tracepoint_enabled(mtrace_new, event); \
+        uint64_t weight; \
+        if ((traced || mtrace_heap_mode) && (ptr) && new_nesting == 0 && \
+                SAMPLE(size, &weight)) { \
+            void *bt[MTRACE_BT_ARRAY_SIZE]; \
+            uint32_t stack_id; \
+            new_nesting++; \
+            stack_id = GET_STACK_ID(bt); \
+            if (mtrace_heap_mode) \
+                mtrace_heap_alloc(ptr, weight, stack_id); \
+            else if (traced && SAMPLING) \
+                TRACK(ptr, weight); \
+            if (traced && !BATCH(op, ptr, size, align, weight, stack_id)) \
+                do_tracepoint(mtrace_new, event, \
+                    size, ptr, __builtin_return_address(0), \
+                    stack_id, weight, ##__VA_ARGS__); \
+            new_nesting--; \
+        } \
+    } while (0)
+
+/*
+ * Forget a released block. Returns whether the release is to be
+ * recorded: with sampling, only if the block was sampled. "weight" is
+ * set to the weight of the block, and "size" to its size if it was 0
+ * and the heap table knows it.
+ */
+static inline int release_block(void *ptr, size_t *size, uint64_t *weight) {
+    struct mtrace_heap_block block;
+
+    if (mtrace_heap_mode && mtrace_heap_free(ptr, &block)) {
+        *weight = block.size;
+        /* Without sampling, the weight of a block is its size */
+        if (!SAMPLING && !*size)
+            *size = block.size;
+        return 1;
+    }
+    if (SAMPLING)
+        return !mtrace_heap_mode && UNTRACK(ptr, weight);
+    *weight = *size;
+    return 1;
+}
+
+/* Record a release. "sz" is 0 when the operator is not sized */
+#define RECORD_DELETE(event, op, ptr, sz) \
+    do { \
+        if (new_nesting++ == 0 && (ptr)) { \
+            size_t freed = (sz); \
+            uint64_t weight = 0; \
+            if (release_block(ptr, &freed, &weight) && \
+                    tracepoint_enabled(mtrace_new, event) && \
+                    !BATCH(op, ptr, freed, 0, weight, 0)) \
+                do_tracepoint(mtrace_new, event, \
+                    ptr, __builtin_return_address(0), freed, weight); \
+        } \
+        new_nesting--; \
+    } while (0)
+
+/*
+ * Allocate the way the standard operators do: retry through the new
+ * handler, then throw std::bad_alloc, or return NULL for the nothrow
+ * variants.
+ */
+static void *allocate(size_t size, size_t alignment, bool nothrow) {
     void *retval;
-    void *bt[BT_ARRAY_SIZE];
-    size_t depth;
 
-    LOOKUP_FUNCTION(cur_alloc.malloc, void* (*)(size_t), malloc);
-    retval = cur_alloc.malloc(size);
+    if (size == 0)
+        size = 1;
+    if (alignment < sizeof(void *))
+        alignment = sizeof(void *);
+
+    for (;;) {
+        if (alignment > sizeof(void *)) {
+            if (real_posix_memalign(&retval, alignment, size) != 0)
+                retval = NULL;
+        } else {
+            retval = real_malloc(size);
+        }
+        if (retval)
+            return retval;
 
-    if (tracepoint_enabled(mtrace_new, new)) {
-        depth = backtrace(bt, BT_ARRAY_SIZE);
-        do_tracepoint(mtrace_new, new,
-            size, retval, __builtin_return_address(0),
-            bt+1, depth-1);
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            if (nothrow)
+                return NULL;
+            throw std::bad_alloc();
+        }
+        if (!nothrow) {
+            handler();
+            continue;
+        }
+        try {
+            handler();
+        } catch (...) {
+            return NULL;
+        }
     }
+}
+
+void * operator new(size_t size) {
+    void *retval = allocate(size, 0, false);
+
+    RECORD_NEW(new, MTRACE_OP_NEW, 0, size, retval);
     return retval;
 }
 
 void * operator new[] (size_t size) {
-    void *retval;
-    void *bt[BT_ARRAY_SIZE];
-    size_t depth;
+    void *retval = allocate(size, 0, false);
 
-    LOOKUP_FUNCTION(cur_alloc.malloc, void* (*)(size_t), malloc);
-    retval = cur_alloc.malloc(size);
+    RECORD_NEW(new_arr, MTRACE_OP_NEW_ARR, 0, size, retval);
+    return retval;
+}
 
-    if (tracepoint_enabled(mtrace_new, new_arr)) {
-        depth = backtrace(bt, BT_ARRAY_SIZE);
-        do_tracepoint(mtrace_new, new_arr,
-            size, retval, __builtin_return_address(0),
-            bt+1, depth-1);
-    }
+void * operator new(size_t size, const std::nothrow_t &) noexcept {
+    void *retval = allocate(size, 0, true);
+
+    RECORD_NEW(new, MTRACE_OP_NEW, 0, size, retval);
     return retval;
 }
 
-void operator delete (void *ptr) {
-    LOOKUP_FUNCTION(cur_alloc.free, void (*)(void *), free);
-    if (tracepoint_enabled(mtrace_new, delete)) {
-        do_tracepoint(mtrace_new, delete,
-            ptr, __builtin_return_address(0));
-    }
+void * operator new[] (size_t size, const std::nothrow_t &) noexcept {
+    void *retval = allocate(size, 0, true);
 
-    cur_alloc.free(ptr);
+    RECORD_NEW(new_arr, MTRACE_OP_NEW_ARR, 0, size, retval);
+    return retval;
 }
 
-void operator delete[] (void *ptr) {
-    LOOKUP_FUNCTION(cur_alloc.free, void (*)(void *), free);
-    if (tracepoint_enabled(mtrace_new, delete_arr)) {
-        do_tracepoint(mtrace_new, delete_arr,
-            ptr, __builtin_return_address(0));
-    }
+void operator delete (void *ptr) noexcept {
+    RECORD_DELETE(delete, MTRACE_OP_DELETE, ptr, 0);
+    real_free(ptr);
+}
 
-    cur_alloc.free(ptr);
+void operator delete[] (void *ptr) noexcept {
+    RECORD_DELETE(delete_arr, MTRACE_OP_DELETE_ARR, ptr, 0);
+    real_free(ptr);
+}
+
+void operator delete (void *ptr, const std::nothrow_t &) noexcept {
+    RECORD_DELETE(delete, MTRACE_OP_DELETE, ptr, 0);
+    real_free(ptr);
+}
+
+void operator delete[] (void *ptr, const std::nothrow_t &) noexcept {
+    RECORD_DELETE(delete_arr, MTRACE_OP_DELETE_ARR, ptr, 0);
+    real_free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete (void *ptr, size_t size) noexcept {
+    RECORD_DELETE(delete, MTRACE_OP_DELETE, ptr, size);
+    real_free(ptr);
+}
+
+void operator delete[] (void *ptr, size_t size) noexcept {
+    RECORD_DELETE(delete_arr, MTRACE_OP_DELETE_ARR, ptr, size);
+    real_free(ptr);
+}
+#endif
+
+#ifdef __cpp_aligned_new
+void * operator new(size_t size, std::align_val_t alignment) {
+    void *retval = allocate(size, (size_t)alignment, false);
+
+    RECORD_NEW(new_aligned, MTRACE_OP_NEW, (size_t)alignment,
+        size, retval, (size_t)alignment);
+    return retval;
+}
+
+void * operator new[] (size_t size, std::align_val_t alignment) {
+    void *retval = allocate(size, (size_t)alignment, false);
+
+    RECORD_NEW(new_arr_aligned, MTRACE_OP_NEW_ARR, (size_t)alignment,
+        size, retval, (size_t)alignment);
+    return retval;
+}
+
+void * operator new(size_t size, std::align_val_t alignment,
+        const std::nothrow_t &) noexcept {
+    void *retval = allocate(size, (size_t)alignment, true);
+
+    RECORD_NEW(new_aligned, MTRACE_OP_NEW, (size_t)alignment,
+        size, retval, (size_t)alignment);
+    return retval;
+}
+
+void * operator new[] (size_t size, std::align_val_t alignment,
+        const std::nothrow_t &) noexcept {
+    void *retval = allocate(size, (size_t)alignment, true);
+
+    RECORD_NEW(new_arr_aligned, MTRACE_OP_NEW_ARR, (size_t)alignment,
+        size, retval, (size_t)alignment);
+    return retval;
+}
+
+void operator delete (void *ptr, std::align_val_t) noexcept {
+    RECORD_DELETE(delete, MTRACE_OP_DELETE, ptr, 0);
+    real_free(ptr);
+}
+
+void operator delete[] (void *ptr, std::align_val_t) noexcept {
+    RECORD_DELETE(delete_arr, MTRACE_OP_DELETE_ARR, ptr, 0);
+    real_free(ptr);
+}
+
+void operator delete (void *ptr, std::align_val_t,
+        const std::nothrow_t &) noexcept {
+    RECORD_DELETE(delete, MTRACE_OP_DELETE, ptr, 0);
+    real_free(ptr);
+}
+
+void operator delete[] (void *ptr, std::align_val_t,
+        const std::nothrow_t &) noexcept {
+    RECORD_DELETE(delete_arr, MTRACE_OP_DELETE_ARR, ptr, 0);
+    real_free(ptr);
+}
+
+#ifdef __cpp_sized_deallocation
+void operator delete (void *ptr, size_t size, std::align_val_t) noexcept {
+    RECORD_DELETE(delete, MTRACE_OP_DELETE, ptr, size);
+    real_free(ptr);
+}
+
+void operator delete[] (void *ptr, size_t size, std::align_val_t) noexcept {
+    RECORD_DELETE(delete_arr, MTRACE_OP_DELETE_ARR, ptr, size);
+    real_free(ptr);
 }
+#endif
+#endif /* __cpp_aligned_new */
 
 __attribute__((constructor))
 static void register_alloc_functions() {
+    mtrace_unwind_init();
+    mtrace_heap_init();
+    mtrace_batch_init();
+#ifndef MTRACE_COMBINED
     lookup_functions();
+#endif
 }
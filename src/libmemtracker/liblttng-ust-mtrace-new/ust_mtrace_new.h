@@ -17,45 +17,111 @@
 #undef TRACEPOINT_PROVIDER
 #define TRACEPOINT_PROVIDER mtrace_new
 
-#if !defined(_TRACEPOINT_UST_LIBC_H) || defined(TRACEPOINT_HEADER_MULTI_READ)
-#define _TRACEPOINT_UST_LIBC_H
+#if !defined(_TRACEPOINT_UST_MTRACE_NEW_H) || defined(TRACEPOINT_HEADER_MULTI_READ)
+#define _TRACEPOINT_UST_MTRACE_NEW_H
 
 #include <lttng/tracepoint.h>
 
 
-TRACEPOINT_EVENT(mtrace_new, new,
-    TP_ARGS(size_t, size, void *, ptr, void *, ip, void *, bt, size_t, depth),
+/*
+ * Backtrace of a stack ID. Recorded the first time the stack is seen,
+ * and the allocation events refer to it by "stack_id". In libmemtracker
+ * the stack IDs are shared with, and defined by, mtrace_malloc:stack_def.
+ */
+TRACEPOINT_EVENT(mtrace_new, stack_def,
+    TP_ARGS(uint32_t, id, void *, bt, size_t, depth),
     TP_FIELDS(
-        ctf_integer(size_t, size, size)
-        ctf_integer_hex(void *, ptr, ptr)
+        ctf_integer(uint32_t, id, id)
         ctf_sequence(void *, bt, bt, size_t, depth)
     )
 )
 
-TRACEPOINT_EVENT(mtrace_new, new_arr,
-    TP_ARGS(size_t, size, void *, ptr, void *, ip, void *, bt, size_t, depth),
+/*
+ * The nothrow variants are recorded as the throwing ones. "weight" is
+ * the number of bytes the event stands for: its size, or the sampling
+ * weight with MTRACE_SAMPLE_BYTES in libmemtracker.
+ */
+TRACEPOINT_EVENT_CLASS(mtrace_new, cls_new,
+    TP_ARGS(size_t, size, void *, ptr, void *, ip, uint32_t, stack_id,
+        uint64_t, weight),
     TP_FIELDS(
         ctf_integer(size_t, size, size)
         ctf_integer_hex(void *, ptr, ptr)
-        ctf_sequence(void *, bt, bt, size_t, depth)
+        ctf_integer(uint32_t, stack_id, stack_id)
+        ctf_integer(uint64_t, weight, weight)
     )
 )
 
-TRACEPOINT_EVENT(mtrace_new, delete,
-    TP_ARGS(void *, ptr, void *, ip),
+TRACEPOINT_EVENT_INSTANCE(mtrace_new, cls_new, new,
+    TP_ARGS(size_t, size, void *, ptr, void *, ip, uint32_t, stack_id,
+        uint64_t, weight)
+)
+
+TRACEPOINT_EVENT_INSTANCE(mtrace_new, cls_new, new_arr,
+    TP_ARGS(size_t, size, void *, ptr, void *, ip, uint32_t, stack_id,
+        uint64_t, weight)
+)
+
+/* std::align_val_t variants */
+TRACEPOINT_EVENT_CLASS(mtrace_new, cls_new_aligned,
+    TP_ARGS(size_t, size, void *, ptr, void *, ip, uint32_t, stack_id,
+        uint64_t, weight, size_t, alignment),
     TP_FIELDS(
+        ctf_integer(size_t, size, size)
         ctf_integer_hex(void *, ptr, ptr)
+        ctf_integer(uint32_t, stack_id, stack_id)
+        ctf_integer(uint64_t, weight, weight)
+        ctf_integer(size_t, alignment, alignment)
     )
 )
 
-TRACEPOINT_EVENT(mtrace_new, delete_arr,
-    TP_ARGS(void *, ptr, void *, ip),
+TRACEPOINT_EVENT_INSTANCE(mtrace_new, cls_new_aligned, new_aligned,
+    TP_ARGS(size_t, size, void *, ptr, void *, ip, uint32_t, stack_id,
+        uint64_t, weight, size_t, alignment)
+)
+
+TRACEPOINT_EVENT_INSTANCE(mtrace_new, cls_new_aligned, new_arr_aligned,
+    TP_ARGS(size_t, size, void *, ptr, void *, ip, uint32_t, stack_id,
+        uint64_t, weight, size_t, alignment)
+)
+
+/*
+ * All the delete operators. "size" comes from the sized variants, or
+ * from the block table in heap mode without sampling, and is 0 when it
+ * is unknown. "weight" is the weight of the block when it was allocated
+ * (see the new events); with sampling only the sampled blocks are
+ * released with an event.
+ */
+TRACEPOINT_EVENT_CLASS(mtrace_new, cls_delete,
+    TP_ARGS(void *, ptr, void *, ip, size_t, size, uint64_t, weight),
     TP_FIELDS(
         ctf_integer_hex(void *, ptr, ptr)
+        ctf_integer(size_t, size, size)
+        ctf_integer(uint64_t, weight, weight)
+    )
+)
+
+TRACEPOINT_EVENT_INSTANCE(mtrace_new, cls_delete, delete,
+    TP_ARGS(void *, ptr, void *, ip, size_t, size, uint64_t, weight)
+)
+
+TRACEPOINT_EVENT_INSTANCE(mtrace_new, cls_delete, delete_arr,
+    TP_ARGS(void *, ptr, void *, ip, size_t, size, uint64_t, weight)
+)
+
+/*
+ * Records of thread "tid" with MTRACE_BATCH: an array of
+ * struct mtrace_batch_rec (see mtrace_batch.h).
+ */
+TRACEPOINT_EVENT(mtrace_new, alloc_batch,
+    TP_ARGS(int, tid, const void *, records, size_t, len),
+    TP_FIELDS(
+        ctf_integer(int, tid, tid)
+        ctf_sequence_hex(uint8_t, records, (const uint8_t *)records, size_t, len)
     )
 )
 
-#endif /* _TRACEPOINT_UST_LIBC_H */
+#endif /* _TRACEPOINT_UST_MTRACE_NEW_H */
 
 #undef TRACEPOINT_INCLUDE
 #define TRACEPOINT_INCLUDE "./ust_mtrace_new.h"
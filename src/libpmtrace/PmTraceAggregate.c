@@ -0,0 +1,563 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "PmTraceBackend.h"
+#include "PmTraceIntern.h"
+#include "PmTraceAggregate.h"
+
+/*
+ * Log-linear histogram of durations in nanoseconds: 4 buckets per power
+ * of 2, which bounds the error of a percentile to 25%, up to ~18 minutes.
+ */
+#define HIST_SUB_BUCKETS    4
+#define HIST_BUCKETS        (40 * HIST_SUB_BUCKETS)
+
+/* Must be powers of 2 */
+#define LOCAL_SLOTS         64
+#define GLOBAL_SLOTS        512
+
+#define BLOCK_STACK_DEPTH   64
+
+#define SLOT_EMPTY  0
+#define SLOT_BUSY   1
+#define SLOT_READY  2
+
+struct histogram {
+    int state;
+    const char* cat;
+    const char* name;
+    uint64_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    uint32_t buckets[HIST_BUCKETS];
+};
+
+/* What merge_local took from a slot of a thread so far */
+struct merged {
+    uint64_t total;
+    uint32_t buckets[HIST_BUCKETS];
+};
+
+struct block_frame {
+    const char* cat;
+    const char* name;
+    uint64_t start;
+};
+
+/*
+ * States are allocated on demand and never freed. The state of an exiting
+ * thread is merged and reused by the next new thread. Only the thread
+ * writes its histograms, and their counts only grow: merging adds what
+ * they gained since the last merge. The lock serializes the merges, and
+ * is never taken by record().
+ */
+struct thread_state {
+    struct thread_state* next;
+    int lock;
+    int in_use;
+    struct histogram slots[LOCAL_SLOTS];
+    struct merged merged[LOCAL_SLOTS];
+    struct block_frame stack[BLOCK_STACK_DEPTH];
+    unsigned int depth;
+};
+
+int pmt_aggregate_mode;
+
+static uint64_t interval_ns;
+static struct histogram* global_slots;
+static struct thread_state* states;
+static pthread_key_t thread_key;
+static __thread struct thread_state* local;
+
+/* Samples which found no slot in the thread or in the global table */
+static uint64_t overflow_count;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void lock_state(struct thread_state* ts) {
+    while (__atomic_exchange_n(&ts->lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(&ts->lock, __ATOMIC_RELAXED))
+            sched_yield();
+    }
+}
+
+static void unlock_state(struct thread_state* ts) {
+    __atomic_store_n(&ts->lock, 0, __ATOMIC_RELEASE);
+}
+
+static unsigned int bucket_index(uint64_t value) {
+    unsigned int exp, index;
+
+    if (value < HIST_SUB_BUCKETS)
+        return value;
+
+    exp = 63 - __builtin_clzll(value);
+    index = (exp - 1) * HIST_SUB_BUCKETS + ((value >> (exp - 2)) & (HIST_SUB_BUCKETS - 1));
+    return index < HIST_BUCKETS ? index : HIST_BUCKETS - 1;
+}
+
+static uint64_t bucket_lower(unsigned int index) {
+    if (index < HIST_SUB_BUCKETS)
+        return index;
+
+    return (uint64_t)(HIST_SUB_BUCKETS + index % HIST_SUB_BUCKETS)
+        << (index / HIST_SUB_BUCKETS - 1);
+}
+
+/* Bounds of the samples, for a histogram whose min and max were missed */
+static void bucket_range(struct histogram* hist) {
+    unsigned int first, last;
+
+    for (first = 0; first < HIST_BUCKETS - 1 && !hist->buckets[first]; first++)
+        ;
+    for (last = HIST_BUCKETS - 1; last > first && !hist->buckets[last]; last--)
+        ;
+    hist->min = bucket_lower(first);
+    hist->max = last < HIST_BUCKETS - 1 ? bucket_lower(last + 1) - 1 : UINT64_MAX;
+}
+
+static uint64_t percentile(const struct histogram* hist, unsigned int pct) {
+    uint64_t rank = (hist->count * pct + 99) / 100;
+    uint64_t seen = 0;
+    uint64_t value = hist->max;
+    unsigned int i;
+
+    for (i = 0; i < HIST_BUCKETS - 1; i++) {
+        seen += hist->buckets[i];
+        if (seen >= rank) {
+            value = bucket_lower(i + 1) - 1;
+            break;
+        }
+    }
+
+    if (value < hist->min)
+        value = hist->min;
+    if (value > hist->max)
+        value = hist->max;
+    return value;
+}
+
+static unsigned int slot_hash(const char* cat, const char* name) {
+    uintptr_t key = (uintptr_t)cat * 31 + (uintptr_t)name;
+
+    return (unsigned int)((key >> 4) * 2654435761u);
+}
+
+static void update_min(uint64_t* min, uint64_t value) {
+    uint64_t cur = __atomic_load_n(min, __ATOMIC_RELAXED);
+
+    while (value < cur && !__atomic_compare_exchange_n(min, &cur, value,
+            1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static void update_max(uint64_t* max, uint64_t value) {
+    uint64_t cur = __atomic_load_n(max, __ATOMIC_RELAXED);
+
+    while (value > cur && !__atomic_compare_exchange_n(max, &cur, value,
+            1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+static struct histogram* find_global(const char* cat, const char* name) {
+    unsigned int hash = slot_hash(cat, name);
+    unsigned int i;
+
+    for (i = 0; i < GLOBAL_SLOTS; i++) {
+        struct histogram* hist = &global_slots[(hash + i) & (GLOBAL_SLOTS - 1)];
+        int state = __atomic_load_n(&hist->state, __ATOMIC_ACQUIRE);
+
+        if (state == SLOT_EMPTY) {
+            if (!__atomic_compare_exchange_n(&hist->state, &state, SLOT_BUSY,
+                    0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+                i--;
+                continue;
+            }
+            hist->cat = cat;
+            hist->name = name;
+            hist->min = UINT64_MAX;
+            __atomic_store_n(&hist->state, SLOT_READY, __ATOMIC_RELEASE);
+            return hist;
+        }
+
+        while (state == SLOT_BUSY)
+            state = __atomic_load_n(&hist->state, __ATOMIC_ACQUIRE);
+
+        if (hist->cat == cat && hist->name == name)
+            return hist;
+    }
+
+    return NULL;
+}
+
+static void reset_histogram(struct histogram* hist) {
+    hist->count = 0;
+    hist->total = 0;
+    hist->min = UINT64_MAX;
+    hist->max = 0;
+    memset(hist->buckets, 0, sizeof(hist->buckets));
+}
+
+/* A sample of a thread whose slots are full goes to the global table */
+static void spill_sample(const char* cat, const char* name, uint64_t duration) {
+    struct histogram* dst = find_global(cat, name);
+
+    if (dst == NULL) {
+        __atomic_add_fetch(&overflow_count, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    __atomic_add_fetch(&dst->count, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&dst->total, duration, __ATOMIC_RELAXED);
+    update_min(&dst->min, duration);
+    update_max(&dst->max, duration);
+    __atomic_add_fetch(&dst->buckets[bucket_index(duration)], 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * Called with the lock of the state held. A sample being recorded meanwhile
+ * is merged next time, but may miss the min and max of this time.
+ */
+static void merge_local(struct thread_state* ts) {
+    uint32_t deltas[HIST_BUCKETS];
+    unsigned int i, j;
+
+    for (i = 0; i < LOCAL_SLOTS; i++) {
+        struct histogram* src = &ts->slots[i];
+        struct merged* done = &ts->merged[i];
+        struct histogram* dst;
+        uint64_t count = 0;
+        uint64_t total, min, max;
+
+        if (__atomic_load_n(&src->state, __ATOMIC_ACQUIRE) != SLOT_READY)
+            continue;
+
+        for (j = 0; j < HIST_BUCKETS; j++) {
+            uint32_t cur = __atomic_load_n(&src->buckets[j], __ATOMIC_ACQUIRE);
+
+            deltas[j] = cur - done->buckets[j];
+            done->buckets[j] = cur;
+            count += deltas[j];
+        }
+        if (count == 0)
+            continue;
+
+        total = __atomic_load_n(&src->total, __ATOMIC_RELAXED);
+        min = __atomic_exchange_n(&src->min, UINT64_MAX, __ATOMIC_RELAXED);
+        max = __atomic_exchange_n(&src->max, 0, __ATOMIC_RELAXED);
+
+        dst = find_global(src->cat, src->name);
+        if (dst) {
+            __atomic_add_fetch(&dst->count, count, __ATOMIC_RELAXED);
+            __atomic_add_fetch(&dst->total, total - done->total, __ATOMIC_RELAXED);
+            update_min(&dst->min, min);
+            update_max(&dst->max, max);
+            for (j = 0; j < HIST_BUCKETS; j++) {
+                if (deltas[j])
+                    __atomic_add_fetch(&dst->buckets[j], deltas[j], __ATOMIC_RELAXED);
+            }
+        } else {
+            __atomic_add_fetch(&overflow_count, count, __ATOMIC_RELAXED);
+        }
+        done->total = total;
+    }
+}
+
+static void flush_global(void) {
+    struct histogram hist;
+    uint64_t overflow;
+    unsigned int i, j;
+
+    /* Nothing would be recorded: keep the counts for the next summary */
+    if (!tracepoint_enabled(pmtrace, block_summary))
+        return;
+
+    for (i = 0; i < GLOBAL_SLOTS; i++) {
+        struct histogram* src = &global_slots[i];
+
+        if (__atomic_load_n(&src->state, __ATOMIC_ACQUIRE) != SLOT_READY)
+            continue;
+
+        hist.count = __atomic_exchange_n(&src->count, 0, __ATOMIC_RELAXED);
+        if (hist.count == 0)
+            continue;
+        hist.total = __atomic_exchange_n(&src->total, 0, __ATOMIC_RELAXED);
+        hist.min = __atomic_exchange_n(&src->min, UINT64_MAX, __ATOMIC_RELAXED);
+        hist.max = __atomic_exchange_n(&src->max, 0, __ATOMIC_RELAXED);
+        for (j = 0; j < HIST_BUCKETS; j++)
+            hist.buckets[j] = __atomic_exchange_n(&src->buckets[j], 0, __ATOMIC_RELAXED);
+        if (hist.min > hist.max)
+            bucket_range(&hist);
+
+        do_tracepoint(pmtrace, block_summary,
+            pmt_intern(src->cat), pmt_intern(src->name),
+            hist.count, hist.total, hist.min, hist.max,
+            percentile(&hist, 50), percentile(&hist, 99));
+    }
+
+    /* Samples without a slot, as a summary of "(overflow)" with only a count */
+    overflow = __atomic_exchange_n(&overflow_count, 0, __ATOMIC_RELAXED);
+    if (overflow) {
+        do_tracepoint(pmtrace, block_summary,
+            pmt_intern("pmtrace"), pmt_intern("(overflow)"),
+            overflow, 0, 0, 0, 0, 0);
+    }
+}
+
+/*
+ * Merge the states into the global table and record the summaries. The
+ * states being updated are skipped, unless "all" is set.
+ */
+static void flush_states(int all) {
+    struct thread_state* ts;
+
+    for (ts = __atomic_load_n(&states, __ATOMIC_ACQUIRE); ts; ts = ts->next) {
+        if (all) {
+            lock_state(ts);
+        } else if (__atomic_exchange_n(&ts->lock, 1, __ATOMIC_ACQUIRE)) {
+            continue;
+        }
+        merge_local(ts);
+        unlock_state(ts);
+    }
+    flush_global();
+}
+
+static void* flush_thread(void* arg) {
+    struct timespec period;
+
+    period.tv_sec = interval_ns / 1000000000;
+    period.tv_nsec = interval_ns % 1000000000;
+    for (;;) {
+        nanosleep(&period, NULL);
+        flush_states(0);
+    }
+    return NULL;
+}
+
+static int start_flush_thread(void) {
+    pthread_attr_t attr;
+    pthread_t thread;
+    sigset_t all, old;
+    int ret;
+
+    /* The flush thread must not take the signals of the application */
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    ret = pthread_create(&thread, &attr, flush_thread, NULL);
+    pthread_attr_destroy(&attr);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return ret;
+}
+
+/* Thread exit: merge the histograms and give the state back */
+static void thread_exit(void* arg) {
+    struct thread_state* ts = arg;
+
+    lock_state(ts);
+    merge_local(ts);
+    ts->depth = 0;
+    local = NULL;
+    __atomic_store_n(&ts->in_use, 0, __ATOMIC_RELEASE);
+    unlock_state(ts);
+}
+
+static struct thread_state* get_local(void) {
+    struct thread_state* ts;
+    unsigned int i;
+
+    if (local)
+        return local;
+
+    for (ts = __atomic_load_n(&states, __ATOMIC_ACQUIRE); ts; ts = ts->next) {
+        int unused = 0;
+
+        if (__atomic_compare_exchange_n(&ts->in_use, &unused, 1, 0,
+                __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+    }
+
+    if (ts == NULL) {
+        ts = calloc(1, sizeof(*ts));
+        if (ts == NULL)
+            return NULL;
+        for (i = 0; i < LOCAL_SLOTS; i++)
+            ts->slots[i].min = UINT64_MAX;
+        ts->in_use = 1;
+        ts->next = __atomic_load_n(&states, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&states, &ts->next, ts, 1,
+                __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+            ;
+    }
+
+    local = ts;
+    pthread_setspecific(thread_key, ts);
+    return ts;
+}
+
+/* Only the thread of "ts" writes its histograms: no lock nor atomic add */
+static void record(struct thread_state* ts, const char* cat, const char* name,
+        uint64_t duration) {
+    unsigned int hash = slot_hash(cat, name);
+    unsigned int i;
+
+    for (i = 0; i < LOCAL_SLOTS; i++) {
+        struct histogram* hist = &ts->slots[(hash + i) & (LOCAL_SLOTS - 1)];
+        uint32_t* bucket;
+
+        if (hist->state == SLOT_EMPTY) {
+            hist->cat = cat;
+            hist->name = name;
+            __atomic_store_n(&hist->state, SLOT_READY, __ATOMIC_RELEASE);
+        } else if (hist->cat != cat || hist->name != name) {
+            continue;
+        }
+
+        bucket = &hist->buckets[bucket_index(duration)];
+        __atomic_store_n(&hist->total, hist->total + duration, __ATOMIC_RELAXED);
+        if (duration < __atomic_load_n(&hist->min, __ATOMIC_RELAXED))
+            __atomic_store_n(&hist->min, duration, __ATOMIC_RELAXED);
+        if (duration > __atomic_load_n(&hist->max, __ATOMIC_RELAXED))
+            __atomic_store_n(&hist->max, duration, __ATOMIC_RELAXED);
+        /* Last, as merge_local counts the samples by their buckets */
+        __atomic_store_n(bucket, *bucket + 1, __ATOMIC_RELEASE);
+        return;
+    }
+
+    spill_sample(cat, name, duration);
+}
+
+/*
+ * Only the forking thread lives on in the child. The samples of the
+ * parent are dropped, as the parent reports them.
+ */
+static void atfork_child(void) {
+    struct thread_state* ts;
+    unsigned int i;
+
+    for (ts = states; ts; ts = ts->next) {
+        ts->lock = 0;
+        if (ts != local) {
+            ts->in_use = 0;
+            ts->depth = 0;
+        }
+        for (i = 0; i < LOCAL_SLOTS; i++)
+            reset_histogram(&ts->slots[i]);
+        memset(ts->merged, 0, sizeof(ts->merged));
+    }
+    for (i = 0; i < GLOBAL_SLOTS; i++) {
+        if (global_slots[i].state == SLOT_READY)
+            reset_histogram(&global_slots[i]);
+    }
+    overflow_count = 0;
+    start_flush_thread();
+}
+
+void pmt_aggregate_init(uint64_t interval_ms) {
+    global_slots = calloc(GLOBAL_SLOTS, sizeof(*global_slots));
+    if (global_slots == NULL || pthread_key_create(&thread_key, thread_exit) != 0)
+        return;
+
+    interval_ns = interval_ms * 1000000;
+    if (start_flush_thread() != 0)
+        return;
+    pthread_atfork(NULL, NULL, atfork_child);
+    pmt_aggregate_mode = 1;
+}
+
+void pmt_aggregate_entry(const char* cat, const char* name) {
+    struct thread_state* ts = get_local();
+    const char* cat_ref;
+    const char* name_ref;
+
+    if (ts == NULL)
+        return;
+
+    pmt_intern_ref(cat, &cat_ref);
+    pmt_intern_ref(name, &name_ref);
+    if (ts->depth < BLOCK_STACK_DEPTH) {
+        ts->stack[ts->depth].cat = cat_ref;
+        ts->stack[ts->depth].name = name_ref;
+        ts->stack[ts->depth].start = now_ns();
+    }
+    ts->depth++;
+}
+
+void pmt_aggregate_exit(const char* cat, const char* name) {
+    struct thread_state* ts = get_local();
+    const char* cat_ref;
+    const char* name_ref;
+    uint64_t now = now_ns();
+    unsigned int depth;
+
+    if (ts == NULL || ts->depth == 0)
+        return;
+
+    /* Too deep to have been recorded */
+    if (ts->depth > BLOCK_STACK_DEPTH) {
+        ts->depth--;
+        return;
+    }
+
+    pmt_intern_ref(cat, &cat_ref);
+    pmt_intern_ref(name, &name_ref);
+
+    /* Unwind to the matching entry. Unmatched exits are ignored. */
+    depth = ts->depth;
+    while (depth > 0) {
+        struct block_frame* frame = &ts->stack[--depth];
+
+        if (frame->cat == cat_ref && frame->name == name_ref) {
+            ts->depth = depth;
+            if (cat_ref && name_ref)
+                record(ts, cat_ref, name_ref, now - frame->start);
+            return;
+        }
+    }
+}
+
+void pmt_aggregate_record(const char* cat, const char* name, uint64_t duration) {
+    struct thread_state* ts = get_local();
+    const char* cat_ref;
+    const char* name_ref;
+
+    if (ts == NULL)
+        return;
+
+    pmt_intern_ref(cat, &cat_ref);
+    pmt_intern_ref(name, &name_ref);
+    if (cat_ref && name_ref)
+        record(ts, cat_ref, name_ref, duration);
+}
+
+void pmt_aggregate_flush(void) {
+    flush_states(1);
+}
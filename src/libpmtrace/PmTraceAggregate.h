@@ -0,0 +1,44 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PMTRACE_AGGREGATE_H
+#define __PMTRACE_AGGREGATE_H
+
+#include <stdint.h>
+
+/**
+ * @brief Aggregation mode for blocks.
+ *
+ * Enabled by PMTRACE_AGGREGATE_MS=<flush interval>. Block entry/exit and
+ * block_complete update per-thread latency histograms instead of
+ * recording events. A background thread records a block_summary event
+ * per category and name every flush interval, and again at exit. While
+ * block_summary is disabled, the samples add up for the next summary.
+ *
+ * Samples which find no room in the histograms of the thread go to the
+ * global table. When that is full too, they are counted and reported in
+ * a block_summary of category "pmtrace" and name "(overflow)", whose only
+ * field is the count.
+ */
+extern int pmt_aggregate_mode __attribute__((visibility("hidden")));
+
+void pmt_aggregate_init(uint64_t interval_ms) __attribute__((visibility("hidden")));
+void pmt_aggregate_entry(const char* cat, const char* name) __attribute__((visibility("hidden")));
+void pmt_aggregate_exit(const char* cat, const char* name) __attribute__((visibility("hidden")));
+void pmt_aggregate_record(const char* cat, const char* name, uint64_t duration) __attribute__((visibility("hidden")));
+void pmt_aggregate_flush(void) __attribute__((visibility("hidden")));
+
+#endif // __PMTRACE_AGGREGATE_H
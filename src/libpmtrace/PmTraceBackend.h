@@ -0,0 +1,46 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PMTRACE_BACKEND_H
+#define __PMTRACE_BACKEND_H
+
+/**
+ * @brief Sink of the events of libPmTrace.
+ *
+ * libPmTrace records its events with tracepoint_enabled/do_tracepoint.
+ * They are LTTng tracepoints, or the ring buffer backend when libPmTrace
+ * is built without lttng-ust (PMTRACE_RINGBUFFER).
+ *
+ * TP_STATE is the state of an event for the inline checks of PmTrace.h.
+ * The structure of the LTTng tracepoints is found at configure time:
+ * "lttng_ust_tracepoint" since lttng-ust 2.13, "tracepoint" before.
+ */
+#ifdef PMTRACE_RINGBUFFER
+#include "PmTraceRingBuffer.h"
+#define TP_STATE(name) (&pmt_rb_state)
+#else
+#include "PmTraceProvider.h"
+#if defined(PMTRACE_UST_TRACEPOINT_STATE)
+#define TP_STATE(name) (&lttng_ust_tracepoint_pmtrace___##name.state)
+#elif defined(PMTRACE_TRACEPOINT_STATE)
+#define TP_STATE(name) (&__tracepoint_pmtrace___##name.state)
+#else
+/* Unknown layout: always call into libPmTrace, which checks tracepoint_enabled() */
+#define TP_STATE(name) (&always_on)
+#endif
+#endif
+
+#endif // __PMTRACE_BACKEND_H
@@ -0,0 +1,189 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "PmTraceBackend.h"
+#include "PmTraceIntern.h"
+
+/* Must be a power of 2 */
+#define INTERN_TABLE_SIZE   4096
+#define INTERN_MAX_PROBES   64
+
+/* Must be a power of 2 */
+#define PTR_CACHE_SIZE      64
+#define PTR_CACHE_SHIFT     (64 - 6)
+
+#define ENTRY_EMPTY     0
+#define ENTRY_BUSY      1
+#define ENTRY_READY     2
+
+struct intern_entry {
+    int state;
+    uint32_t hash;
+    uint32_t id;
+    unsigned int gen;
+    const char* str;
+};
+
+struct ptr_cache_entry {
+    const char* str;
+    struct intern_entry* entry;
+};
+
+static struct intern_entry intern_table[INTERN_TABLE_SIZE];
+static uint32_t last_id;
+
+/*
+ * Entries of the thread by string address. The strings are literals in
+ * practice, so most lookups skip hashing and probing the table. A hit is
+ * still compared, as a reused buffer may hold another string by now.
+ */
+static __thread struct ptr_cache_entry ptr_cache[PTR_CACHE_SIZE];
+
+/*
+ * Bumped whenever string_def gets enabled, so that the definitions are
+ * recorded again for the new session.
+ */
+static unsigned int def_gen = 1;
+static int def_enabled;
+
+static uint32_t hash_str(const char* str) {
+    uint32_t hash = 2166136261u;
+
+    while (*str) {
+        hash ^= (unsigned char)*str++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static struct ptr_cache_entry* ptr_cache_slot(const char* str) {
+    uint64_t key = (uint64_t)(uintptr_t)str * 0x9e3779b97f4a7c15ull;
+
+    return &ptr_cache[key >> PTR_CACHE_SHIFT];
+}
+
+static int string_def_enabled(void) {
+    int enabled = tracepoint_enabled(pmtrace, string_def) ? 1 : 0;
+
+    if (__atomic_load_n(&def_enabled, __ATOMIC_RELAXED) != enabled &&
+            __atomic_exchange_n(&def_enabled, enabled, __ATOMIC_RELAXED) != enabled &&
+            enabled) {
+        __atomic_add_fetch(&def_gen, 1, __ATOMIC_RELAXED);
+    }
+    return enabled;
+}
+
+static void define_string(struct intern_entry* entry, int enabled) {
+    unsigned int gen = __atomic_load_n(&def_gen, __ATOMIC_RELAXED);
+
+    if (!enabled || __atomic_load_n(&entry->gen, __ATOMIC_RELAXED) == gen)
+        return;
+
+    __atomic_store_n(&entry->gen, gen, __ATOMIC_RELAXED);
+    do_tracepoint(pmtrace, string_def, entry->id, (char*)entry->str);
+}
+
+uint32_t pmt_intern(const char* str) {
+    return pmt_intern_ref(str, NULL);
+}
+
+uint32_t pmt_intern_ref(const char* str, const char** ref) {
+    int enabled = string_def_enabled();
+    struct ptr_cache_entry* cached;
+    uint32_t hash;
+    uint32_t id;
+    unsigned int i;
+
+    if (str == NULL)
+        str = "";
+
+    cached = ptr_cache_slot(str);
+    if (cached->str == str && strcmp(cached->entry->str, str) == 0) {
+        define_string(cached->entry, enabled);
+        if (ref)
+            *ref = cached->entry->str;
+        return cached->entry->id;
+    }
+
+    hash = hash_str(str);
+    for (i = 0; i < INTERN_MAX_PROBES; i++) {
+        struct intern_entry* entry = &intern_table[(hash + i) & (INTERN_TABLE_SIZE - 1)];
+        int state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+
+        if (state == ENTRY_EMPTY) {
+            char* copy;
+
+            if (!__atomic_compare_exchange_n(&entry->state, &state, ENTRY_BUSY,
+                    0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE)) {
+                /* Lost the slot. Look at it again with its new state. */
+                i--;
+                continue;
+            }
+
+            copy = strdup(str);
+            if (copy == NULL) {
+                __atomic_store_n(&entry->state, ENTRY_EMPTY, __ATOMIC_RELEASE);
+                break;
+            }
+            entry->str = copy;
+            entry->hash = hash;
+            entry->id = __atomic_add_fetch(&last_id, 1, __ATOMIC_RELAXED);
+            entry->gen = 0;
+            __atomic_store_n(&entry->state, ENTRY_READY, __ATOMIC_RELEASE);
+
+            define_string(entry, enabled);
+            cached->str = str;
+            cached->entry = entry;
+            if (ref)
+                *ref = entry->str;
+            return entry->id;
+        }
+
+        while (state == ENTRY_BUSY)
+            state = __atomic_load_n(&entry->state, __ATOMIC_ACQUIRE);
+
+        if (state == ENTRY_READY && entry->hash == hash && strcmp(entry->str, str) == 0) {
+            define_string(entry, enabled);
+            cached->str = str;
+            cached->entry = entry;
+            if (ref)
+                *ref = entry->str;
+            return entry->id;
+        }
+    }
+
+    /* No room for the string. Define a new ID on every use. */
+    id = __atomic_add_fetch(&last_id, 1, __ATOMIC_RELAXED);
+    if (ref)
+        *ref = NULL;
+    if (enabled)
+        do_tracepoint(pmtrace, string_def, id, (char*)str);
+    return id;
+}
+
+void pmt_intern_foreach(void (*fn)(uint32_t id, const char* str, void* arg), void* arg) {
+    unsigned int i;
+
+    for (i = 0; i < INTERN_TABLE_SIZE; i++) {
+        struct intern_entry* entry = &intern_table[i];
+
+        if (__atomic_load_n(&entry->state, __ATOMIC_ACQUIRE) == ENTRY_READY)
+            fn(entry->id, entry->str, arg);
+    }
+}
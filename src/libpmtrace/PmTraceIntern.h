@@ -0,0 +1,48 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PMTRACE_INTERN_H
+#define __PMTRACE_INTERN_H
+
+#include <stdint.h>
+
+/**
+ * @brief Return a small integer ID for a category, name or format string.
+ *
+ * The first time a string is seen (and again whenever the "string_def"
+ * event gets enabled) a string_def event maps the ID to the string, so
+ * other events record only the ID.
+ */
+uint32_t pmt_intern(const char* str) __attribute__((visibility("hidden")));
+
+/**
+ * @brief pmt_intern which also returns the registry's copy of the string.
+ *
+ * Equal strings share the same copy, so it can be compared by address.
+ * "ref" is set to NULL when the registry has no room for the string.
+ */
+uint32_t pmt_intern_ref(const char* str, const char** ref) __attribute__((visibility("hidden")));
+
+/**
+ * @brief Call "fn" for every string in the registry.
+ *
+ * Lock-free and async-signal-safe. Strings being added meanwhile may
+ * be missed.
+ */
+void pmt_intern_foreach(void (*fn)(uint32_t id, const char* str, void* arg), void* arg)
+    __attribute__((visibility("hidden")));
+
+#endif // __PMTRACE_INTERN_H
@@ -0,0 +1,241 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <string.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#include "PmTracePerfLog.h"
+
+/* Must be a power of 2 */
+#define QUEUE_SIZE      256
+
+/* How long the writer waits for more messages after a wake-up */
+#define BATCH_DELAY_MS  5
+
+#define WRITER_STOPPED  0
+#define WRITER_STARTING 1
+#define WRITER_RUNNING  2
+#define WRITER_FAILED   3
+
+/*
+ * Bounded multi-producer queue. "seq" of a cell tells whether it is
+ * free for the producer of position "seq" or filled for the consumer
+ * of position "seq - 1". Static, so that messages can be queued while
+ * the writer is being started.
+ */
+struct cell {
+    size_t seq;
+    size_t len;
+    char msg[PERFLOG_MSG_MAX];
+};
+
+static struct cell queue[QUEUE_SIZE];
+static size_t enqueue_pos;
+static size_t dequeue_pos;
+
+static int writer_state;
+static int writer_sleeping;
+
+/* Reported by the writer: messages lost to a full queue, and cut short */
+static unsigned int dropped;
+static unsigned int truncated;
+
+static void futex_wait(int* addr, int val) {
+    syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(int* addr) {
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+static void reset_queue(void) {
+    size_t i;
+
+    for (i = 0; i < QUEUE_SIZE; i++)
+        __atomic_store_n(&queue[i].seq, i, __ATOMIC_RELAXED);
+    enqueue_pos = 0;
+    dequeue_pos = 0;
+    dropped = 0;
+    truncated = 0;
+}
+
+static void wake_writer(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&writer_sleeping, __ATOMIC_RELAXED) &&
+            __atomic_exchange_n(&writer_sleeping, 0, __ATOMIC_RELAXED))
+        futex_wake(&writer_sleeping);
+}
+
+static int enqueue(const char* msg, size_t len) {
+    size_t pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+    struct cell* cell;
+
+    for (;;) {
+        size_t seq;
+        intptr_t diff;
+
+        cell = &queue[pos & (QUEUE_SIZE - 1)];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&enqueue_pos, &pos, pos + 1,
+                    1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = __atomic_load_n(&enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(cell->msg, msg, len);
+    cell->msg[len] = '\0';
+    cell->len = len;
+    __atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/* Also used by the exiting thread, so consumers race for the cells too */
+static int dequeue_one(void) {
+    size_t pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+    struct cell* cell;
+
+    for (;;) {
+        size_t seq;
+        intptr_t diff;
+
+        cell = &queue[pos & (QUEUE_SIZE - 1)];
+        seq = __atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE);
+        diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&dequeue_pos, &pos, pos + 1,
+                    1, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        } else if (diff < 0) {
+            return 0;
+        } else {
+            pos = __atomic_load_n(&dequeue_pos, __ATOMIC_RELAXED);
+        }
+    }
+
+    syslog(LOG_INFO, "%s", cell->msg);
+    __atomic_store_n(&cell->seq, pos + QUEUE_SIZE, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static void drain(void) {
+    unsigned int lost;
+
+    while (dequeue_one())
+        ;
+
+    lost = __atomic_exchange_n(&dropped, 0, __ATOMIC_RELAXED);
+    if (lost)
+        syslog(LOG_WARNING, "pmtrace: %u perflog messages dropped", lost);
+    lost = __atomic_exchange_n(&truncated, 0, __ATOMIC_RELAXED);
+    if (lost)
+        syslog(LOG_WARNING, "pmtrace: %u perflog messages truncated to %d bytes",
+            lost, PERFLOG_MSG_MAX - 1);
+}
+
+static int queue_empty(void) {
+    size_t pos = __atomic_load_n(&dequeue_pos, __ATOMIC_SEQ_CST);
+
+    return __atomic_load_n(&queue[pos & (QUEUE_SIZE - 1)].seq, __ATOMIC_SEQ_CST) != pos + 1;
+}
+
+static void* writer_main(void* arg) {
+    struct timespec delay = { 0, BATCH_DELAY_MS * 1000000L };
+    sigset_t set;
+
+    /* Leave the signals to the application threads */
+    sigfillset(&set);
+    pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+    for (;;) {
+        drain();
+
+        __atomic_store_n(&writer_sleeping, 1, __ATOMIC_SEQ_CST);
+        if (queue_empty())
+            futex_wait(&writer_sleeping, 1);
+        __atomic_store_n(&writer_sleeping, 0, __ATOMIC_RELAXED);
+
+        /* Let a burst of messages pile up, and write them at once */
+        nanosleep(&delay, NULL);
+    }
+
+    return NULL;
+}
+
+static void atfork_child(void) {
+    /* The writer thread is not forked, and the parent writes its messages */
+    reset_queue();
+    writer_sleeping = 0;
+    if (writer_state != WRITER_FAILED)
+        writer_state = WRITER_STOPPED;
+}
+
+static void start_writer(void) {
+    int state = __atomic_load_n(&writer_state, __ATOMIC_ACQUIRE);
+    pthread_attr_t attr;
+    pthread_t thread;
+
+    /* Another thread may be starting it. Do not wait. */
+    if (__builtin_expect(state != WRITER_STOPPED, 1) ||
+            !__atomic_compare_exchange_n(&writer_state, &state, WRITER_STARTING,
+                0, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE))
+        return;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    state = pthread_create(&thread, &attr, writer_main, NULL) == 0 ?
+        WRITER_RUNNING : WRITER_FAILED;
+    pthread_attr_destroy(&attr);
+
+    __atomic_store_n(&writer_state, state, __ATOMIC_RELEASE);
+}
+
+void pmt_perflog_init(void) {
+    reset_queue();
+    pthread_atfork(NULL, NULL, atfork_child);
+}
+
+void pmt_perflog_syslog(const char* msg, size_t len) {
+    if (len >= PERFLOG_MSG_MAX) {
+        len = PERFLOG_MSG_MAX - 1;
+        __atomic_add_fetch(&truncated, 1, __ATOMIC_RELAXED);
+    }
+
+    if (enqueue(msg, len) < 0)
+        __atomic_add_fetch(&dropped, 1, __ATOMIC_RELAXED);
+
+    /* Also while the writer starts: it may have looked at the queue already */
+    start_writer();
+    wake_writer();
+}
+
+void pmt_perflog_flush(void) {
+    drain();
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PMTRACE_PERFLOG_H
+#define __PMTRACE_PERFLOG_H
+
+#include <stddef.h>
+
+/* Longest PmtPerfLog message stored in the queue. Longer ones are truncated. */
+#define PERFLOG_MSG_MAX     1024
+
+/**
+ * @brief Set up the queue. Called by the constructor of the library.
+ */
+void pmt_perflog_init(void) __attribute__((visibility("hidden")));
+
+/**
+ * @brief Queue a PmtPerfLog message for syslog.
+ *
+ * A writer thread started on first use drains the queue to syslog() in
+ * batches, so the caller never blocks on /dev/log nor allocates. Messages
+ * are written in order. When the queue is full the message is dropped,
+ * and messages of PERFLOG_MSG_MAX bytes or more are truncated; the writer
+ * logs how many were. Without a writer thread, the queue is written out
+ * at exit.
+ */
+void pmt_perflog_syslog(const char* msg, size_t len) __attribute__((visibility("hidden")));
+
+/**
+ * @brief Write out the queued messages. Called at exit.
+ */
+void pmt_perflog_flush(void) __attribute__((visibility("hidden")));
+
+#endif // __PMTRACE_PERFLOG_H
@@ -14,63 +14,419 @@
 //
 // SPDX-License-Identifier: Apache-2.0
 
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
+#ifndef PMTRACE_RINGBUFFER
 #define TRACEPOINT_CREATE_PROBES
 #define TRACEPOINT_DEFINE
-#include "PmTraceProvider.h"
+#endif
+#include "PmTraceBackend.h"
+#include "PmTraceKv.h"
+#include "PmTraceIntern.h"
+#include "PmTraceAggregate.h"
+#include "PmTraceSampling.h"
+#include "PmTracePerfLog.h"
 
+/*
+ * Payloads up to MAXSTRBUFLEN are formatted on the stack. Longer ones
+ * are formatted again in a per-thread scratch buffer, which grows up to
+ * MAXSCRATCHLEN and is then reused by the thread.
+ */
 #define MAXSTRBUFLEN    128
+#define MAXSCRATCHLEN   (64 * 1024)
+
+/*
+ * Tracepoint states exported for the inline checks of PmTrace.h.
+ * LTTng updates them when the events are enabled or disabled.
+ * The ring buffer backend has a single state for all the events.
+ * In the aggregation mode the block events point to "always_on", as do
+ * all the events when the tracepoint layout of lttng-ust is unknown.
+ */
+#define EXPORT_TP_STATE(name) \
+    const int* _PmtState_##name = TP_STATE(name)
+
+static const int always_on = 1;
+
+EXPORT_TP_STATE(log_kv);
+EXPORT_TP_STATE(block_entry_kv);
+EXPORT_TP_STATE(block_exit_kv);
+EXPORT_TP_STATE(marker_kv);
+EXPORT_TP_STATE(block_complete);
+EXPORT_TP_STATE(perflog);
+
+/*
+ * Minimum duration of block_complete events, from PMTRACE_BLOCK_MIN_US.
+ * Checked by the callers before calling into libPmTrace.
+ */
+uint64_t _PmtBlockMinNs;
+
+struct scratch {
+    char* buf;
+    size_t size;
+};
+
+static pthread_key_t scratch_key;
+static __thread struct scratch scratch;
+
+/* Payloads which used to be truncated to MAXSTRBUFLEN */
+static uint64_t oversize_count;
+
+static void free_scratch(void* buf) {
+    scratch.buf = NULL;
+    scratch.size = 0;
+    free(buf);
+}
+
+/*
+ * Return the scratch buffer of the thread, grown to "*size" bytes if
+ * possible. "*size" is set to the usable size.
+ */
+static char* get_scratch(size_t* size) {
+    if (scratch.size < *size && scratch.size < MAXSCRATCHLEN) {
+        size_t new_size = scratch.size ? scratch.size : 1024;
+        char* buf;
+
+        while (new_size < *size && new_size < MAXSCRATCHLEN)
+            new_size *= 2;
+        buf = realloc(scratch.buf, new_size);
+        if (buf) {
+            scratch.buf = buf;
+            scratch.size = new_size;
+            pthread_setspecific(scratch_key, buf);
+        }
+    }
+
+    if (*size > scratch.size)
+        *size = scratch.size;
+    return scratch.buf;
+}
+
+static void note_oversize(size_t size) {
+    uint64_t count = __atomic_add_fetch(&oversize_count, 1, __ATOMIC_RELAXED);
+
+    if (tracepoint_enabled(pmtrace, payload_oversize))
+        do_tracepoint(pmtrace, payload_oversize, size, count);
+}
+
+__attribute__((constructor))
+static void pmtrace_init(void) {
+    const char* env = getenv("PMTRACE_BLOCK_MIN_US");
+
+    if (env)
+        _PmtBlockMinNs = strtoull(env, NULL, 10) * 1000;
+
+    pthread_key_create(&scratch_key, free_scratch);
+
+#ifdef PMTRACE_RINGBUFFER
+    pmt_rb_init();
+#endif
+    pmt_sampling_init();
+    pmt_perflog_init();
+
+    env = getenv("PMTRACE_AGGREGATE_MS");
+    if (env && strtoull(env, NULL, 10) > 0) {
+        pmt_aggregate_init(strtoull(env, NULL, 10));
+        if (pmt_aggregate_mode) {
+            _PmtState_block_entry_kv = &always_on;
+            _PmtState_block_exit_kv = &always_on;
+            _PmtState_block_complete = &always_on;
+        }
+    }
+}
+
+__attribute__((destructor))
+static void pmtrace_fini(void) {
+    if (pmt_aggregate_mode)
+        pmt_aggregate_flush();
+
+    pmt_perflog_flush();
+}
+
+static const char* format_payload(char* buf, const char* fmt, va_list args) {
+    va_list copy;
+    size_t size;
+    int n;
+
+    va_copy(copy, args);
+    n = vsnprintf(buf, MAXSTRBUFLEN, fmt, args);
+    if (n >= MAXSTRBUFLEN) {
+        char* big;
+
+        note_oversize(n);
+        size = n + 1;
+        big = get_scratch(&size);
+        if (big) {
+            vsnprintf(big, size, fmt, copy);
+            buf = big;
+        }
+    }
+    va_end(copy);
+
+    return buf;
+}
 
 #define CREATE_MSG_FROM_VA(str) \
+    char str##_buf[MAXSTRBUFLEN]; \
+    const char* str; \
     do { \
         va_list args; \
         va_start(args, fmt); \
-        vsnprintf(str, MAXSTRBUFLEN, fmt, args); \
+        str = format_payload(str##_buf, fmt, args); \
         va_end(args); \
     } while(0)
 
-void _PmtLog(const char* cat, const char* fmt, ...) {
-    if (tracepoint_enabled(pmtrace, log)) {
-        char payload[MAXSTRBUFLEN];
+/*
+ * Copy the typed values of a binary payload for recording.
+ * Strings are gathered into "*text" and referred by their offsets.
+ * "*text" is switched to the scratch buffer when MAXSTRBUFLEN is short.
+ */
+static size_t gather_kv(const _PmtKvList* kv, int64_t* values, char** text) {
+    size_t lens[PMT_KV_MAX];
+    size_t need = 0;
+    size_t size = MAXSTRBUFLEN;
+    size_t text_len = 0;
+    unsigned int i;
+
+    for (i = 0; i < kv->count; i++) {
+        if (kv->types[i] == PMT_KV_STRING) {
+            const char* str = (const char*)(intptr_t)kv->values[i];
+
+            lens[i] = strlen(str ? str : "(null)");
+            need += lens[i] + 1;
+        }
+    }
+
+    if (need > MAXSTRBUFLEN) {
+        char* big;
 
+        note_oversize(need);
+        size = need;
+        big = get_scratch(&size);
+        if (big)
+            *text = big;
+        else
+            size = MAXSTRBUFLEN;
+    }
+
+    for (i = 0; i < kv->count; i++) {
+        const char* str;
+        size_t len;
+
+        if (kv->types[i] != PMT_KV_STRING) {
+            values[i] = kv->values[i];
+            continue;
+        }
+
+        str = (const char*)(intptr_t)kv->values[i];
+        if (str == NULL)
+            str = "(null)";
+        len = lens[i];
+        if (len > size - text_len - 1)
+            len = size - text_len - 1;
+        memcpy(*text + text_len, str, len);
+        (*text)[text_len + len] = '\0';
+
+        values[i] = text_len;
+        text_len += len + 1;
+        if (text_len == size)
+            text_len--;
+    }
+
+    return text_len;
+}
+
+#define CREATE_KV_RECORD(values, text, text_len) \
+    int64_t values[PMT_KV_MAX]; \
+    char text##_buf[MAXSTRBUFLEN]; \
+    char* text = text##_buf; \
+    size_t text_len = gather_kv(kv, values, &text)
+
+void _PmtLog(const char* cat, const char* fmt, ...) {
+    if (tracepoint_enabled(pmtrace, log) && PMT_SAMPLED(cat)) {
         CREATE_MSG_FROM_VA(payload);
-        do_tracepoint(pmtrace, log, (char*)cat, payload);
+
+        do_tracepoint(pmtrace, log, (char*)cat, (char*)payload);
     }
 }
 
 void _PmtBlockEntry(const char* cat, const char* name, const char* fmt, ...) {
-    if (tracepoint_enabled(pmtrace, block_entry)) {
-        char payload[MAXSTRBUFLEN];
+    if (pmt_aggregate_mode) {
+        pmt_aggregate_entry(cat, name);
+        return;
+    }
 
+    if (tracepoint_enabled(pmtrace, block_entry) && PMT_SAMPLED_ENTRY(cat)) {
         CREATE_MSG_FROM_VA(payload);
-        do_tracepoint(pmtrace, block_entry, (char*)cat, (char*)name, payload);
+
+        do_tracepoint(pmtrace, block_entry, (char*)cat, (char*)name, (char*)payload);
     }
 }
 
 void _PmtBlockExit(const char* cat, const char* name, const char* fmt, ...) {
-    if (tracepoint_enabled(pmtrace, block_exit)) {
-        char payload[MAXSTRBUFLEN];
+    if (pmt_aggregate_mode) {
+        pmt_aggregate_exit(cat, name);
+        return;
+    }
 
+    if (tracepoint_enabled(pmtrace, block_exit) && PMT_SAMPLED_EXIT()) {
         CREATE_MSG_FROM_VA(payload);
-        do_tracepoint(pmtrace, block_exit, (char*)cat, (char*)name, payload);
+
+        do_tracepoint(pmtrace, block_exit, (char*)cat, (char*)name, (char*)payload);
     }
 }
 
 void _PmtMarker(const char* cat, const char* name, const char* fmt, ...) {
-    if (tracepoint_enabled(pmtrace, marker)) {
-        char payload[MAXSTRBUFLEN];
-
+    if (tracepoint_enabled(pmtrace, marker) && PMT_SAMPLED(cat)) {
         CREATE_MSG_FROM_VA(payload);
-        do_tracepoint(pmtrace, marker, (char*)cat, (char*)name, payload);
+
+        do_tracepoint(pmtrace, marker, (char*)cat, (char*)name, (char*)payload);
     }
 }
 
 void _PmtPerfLog(const char* cat, const char* name, const char* fmt, ...) {
     if (tracepoint_enabled(pmtrace, perflog)) {
-        char payload[MAXSTRBUFLEN];
-
         CREATE_MSG_FROM_VA(payload);
-        do_tracepoint(pmtrace, perflog, (char*)cat, (char*)name, payload);
+
+        do_tracepoint(pmtrace, perflog, (char*)cat, (char*)name, (char*)payload);
+    }
+}
+
+void _PmtLogKv(const char* cat, const char* fmt, const _PmtKvList* kv) {
+    if (tracepoint_enabled(pmtrace, log_kv) && PMT_SAMPLED(cat)) {
+        CREATE_KV_RECORD(values, text, text_len);
+
+        do_tracepoint(pmtrace, log_kv, pmt_intern(cat), pmt_intern(fmt),
+            kv->types, values, kv->count, text, text_len);
+    }
+}
+
+void _PmtBlockEntryKv(const char* cat, const char* name, const char* fmt, const _PmtKvList* kv) {
+    if (pmt_aggregate_mode) {
+        pmt_aggregate_entry(cat, name);
+        return;
+    }
+
+    if (tracepoint_enabled(pmtrace, block_entry_kv) && PMT_SAMPLED_ENTRY(cat)) {
+        CREATE_KV_RECORD(values, text, text_len);
+
+        do_tracepoint(pmtrace, block_entry_kv, pmt_intern(cat), pmt_intern(name), pmt_intern(fmt),
+            kv->types, values, kv->count, text, text_len);
+    }
+}
+
+void _PmtBlockExitKv(const char* cat, const char* name, const char* fmt, const _PmtKvList* kv) {
+    if (pmt_aggregate_mode) {
+        pmt_aggregate_exit(cat, name);
+        return;
+    }
+
+    if (tracepoint_enabled(pmtrace, block_exit_kv) && PMT_SAMPLED_EXIT()) {
+        CREATE_KV_RECORD(values, text, text_len);
+
+        do_tracepoint(pmtrace, block_exit_kv, pmt_intern(cat), pmt_intern(name), pmt_intern(fmt),
+            kv->types, values, kv->count, text, text_len);
+    }
+}
+
+void _PmtMarkerKv(const char* cat, const char* name, const char* fmt, const _PmtKvList* kv) {
+    if (tracepoint_enabled(pmtrace, marker_kv) && PMT_SAMPLED(cat)) {
+        CREATE_KV_RECORD(values, text, text_len);
+
+        do_tracepoint(pmtrace, marker_kv, pmt_intern(cat), pmt_intern(name), pmt_intern(fmt),
+            kv->types, values, kv->count, text, text_len);
     }
 }
+
+/*
+ * Monotonic time in nanoseconds for block_complete and PmtPerfLog.
+ * It lives here rather than inline in PmTrace.h, so that clients built
+ * with a strict -std=c99 or c11 need no POSIX feature macro.
+ */
+uint64_t _PmtNow(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+void _PmtBlockComplete(const char* cat, const char* name, uint64_t start, uint64_t duration) {
+    if (pmt_aggregate_mode) {
+        if (duration >= _PmtBlockMinNs)
+            pmt_aggregate_record(cat, name, duration);
+        return;
+    }
+
+    if (tracepoint_enabled(pmtrace, block_complete) && duration >= _PmtBlockMinNs &&
+            PMT_SAMPLED(cat)) {
+        do_tracepoint(pmtrace, block_complete, pmt_intern(cat), pmt_intern(name),
+            start, duration);
+    }
+}
+
+/*
+ * Format a PmtPerfLog message into "buf" and return its full length.
+ * The keys come first in the order perf_log_viewer.py expects, then the
+ * "{...}" of the argument macros is merged into the message.
+ */
+static size_t format_perflog(char* buf, size_t size, const char* ctx, const char* msgid,
+        const char* type, const char* group, uint64_t clock, const char* fmt, va_list args) {
+    size_t len;
+
+    len = snprintf(buf, size,
+        "{\"ctx\":\"%s\", \"CLOCK\":\"%" PRIu64 ".%03u\", \"msgid\":\"%s\", "
+        "\"PerfType\":\"%s\", \"PerfGroup\":\"%s\"%s",
+        ctx, clock / 1000000000, (unsigned int)(clock % 1000000000 / 1000000),
+        msgid, type, group, fmt[0] == '{' ? ", " : "}");
+
+    if (fmt[0] == '{')
+        len += vsnprintf(buf + (len < size ? len : size), len < size ? size - len : 0, fmt + 1, args);
+    return len;
+}
+
+/*
+ * The PmtPerfLog message is formatted once in the scratch buffer of the
+ * thread and shared by syslog and the perflog_clock event. A message
+ * longer than the buffer is measured and formatted again after growing it.
+ */
+void _PmtPerfLogClock(const char* ctx, const char* msgid, const char* type, const char* group,
+        uint64_t clock, const char* fmt, ...) {
+    size_t size = PERFLOG_MSG_MAX;
+    char* buf = get_scratch(&size);
+    char small[MAXSTRBUFLEN];
+    va_list args;
+    size_t len;
+
+    if (!buf) {
+        buf = small;
+        size = sizeof(small);
+    }
+
+    va_start(args, fmt);
+    len = format_perflog(buf, size, ctx, msgid, type, group, clock, fmt, args);
+    va_end(args);
+
+    if (len >= size) {
+        size_t need = len + 1;
+        char* big = get_scratch(&need);
+
+        if (big && need > size) {
+            buf = big;
+            size = need;
+            va_start(args, fmt);
+            len = format_perflog(buf, size, ctx, msgid, type, group, clock, fmt, args);
+            va_end(args);
+        }
+        if (len >= size)
+            len = size - 1;
+    }
+
+    pmt_perflog_syslog(buf, len);
+
+    if (tracepoint_enabled(pmtrace, perflog_clock))
+        do_tracepoint(pmtrace, perflog_clock, (char*)ctx, (char*)msgid, clock, buf);
+}
@@ -0,0 +1,708 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "PmTraceRingBuffer.h"
+#include "PmTraceIntern.h"
+
+#define DEFAULT_RING_SIZE_KB    64
+#define DEFAULT_SLOT_COUNT      64
+#define MAX_SLOT_COUNT          1024
+
+/* Signal stack of the threads, for the crash dumps of stack overflows */
+#define ALTSTACK_SIZE           (64 * 1024)
+
+#define RECORD_ALIGN(size)      (((size) + 7) & ~(size_t)7)
+#define RECORD_HEADER_SIZE      sizeof(struct pmt_rb_record)
+
+struct thread_slot {
+    unsigned int gen;
+    int index;
+    int busy;
+};
+
+int pmt_rb_state;
+
+static char* segment;
+static size_t segment_size;
+static char shm_name[32];
+static struct pmt_rb_header* header;
+static struct pmt_rb_slot* slots;
+static char* rings;
+static uint32_t ring_size;
+static uint32_t slot_count;
+
+/* Bumped on every (re)initialization, so stale thread slots are dropped */
+static unsigned int rb_gen;
+static pthread_key_t slot_key;
+static __thread struct thread_slot local = { 0, -1, 0 };
+
+/* Preallocated for the dumper, which runs in signal handlers */
+static char* dump_buf;
+static char dump_path[256];
+static int dumping;
+
+/* Dump on crashes, only when PMTRACE_RB_DUMP is set */
+static int crash_dumps;
+
+/* Dump on this signal, only when PMTRACE_RB_SIGNAL is set */
+static int dump_signal;
+static __thread void* altstack;
+
+static const int crash_signals[] = { SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT };
+#define CRASH_SIGNAL_COUNT  (sizeof(crash_signals) / sizeof(crash_signals[0]))
+static struct sigaction old_actions[CRASH_SIGNAL_COUNT];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t env_u32(const char* name, uint32_t def) {
+    const char* env = getenv(name);
+
+    return env ? (uint32_t)strtoul(env, NULL, 10) : def;
+}
+
+/*
+    Per-thread slots
+*/
+static void setup_altstack(void) {
+    stack_t ss;
+
+    /* Keep the signal stack of the application */
+    if (!crash_dumps || altstack || sigaltstack(NULL, &ss) != 0 || !(ss.ss_flags & SS_DISABLE))
+        return;
+
+    ss.ss_sp = mmap(NULL, ALTSTACK_SIZE, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ss.ss_sp == MAP_FAILED)
+        return;
+    ss.ss_size = ALTSTACK_SIZE;
+    ss.ss_flags = 0;
+    if (sigaltstack(&ss, NULL) != 0) {
+        munmap(ss.ss_sp, ALTSTACK_SIZE);
+        return;
+    }
+    altstack = ss.ss_sp;
+}
+
+static void free_altstack(void) {
+    stack_t ss;
+
+    if (!altstack)
+        return;
+
+    memset(&ss, 0, sizeof(ss));
+    ss.ss_flags = SS_DISABLE;
+    sigaltstack(&ss, NULL);
+    munmap(altstack, ALTSTACK_SIZE);
+    altstack = NULL;
+}
+
+static void release_slot(void* arg) {
+    struct thread_slot* ts = arg;
+
+    free_altstack();
+
+    if (ts->gen != rb_gen || ts->index < 0)
+        return;
+
+    /* Keep the events of the exited thread until the slot is claimed again */
+    __atomic_store_n(&slots[ts->index].tid, -slots[ts->index].tid, __ATOMIC_RELEASE);
+    ts->index = -1;
+}
+
+static int claim_slot(void) {
+    int32_t tid = (int32_t)syscall(SYS_gettid);
+    int pass;
+    uint32_t i;
+
+    /* Prefer the unused slots, then the ones left by exited threads */
+    for (pass = 0; pass < 2; pass++) {
+        for (i = 0; i < slot_count; i++) {
+            int32_t expected = __atomic_load_n(&slots[i].tid, __ATOMIC_RELAXED);
+
+            if (pass == 0 ? expected != 0 : expected >= 0)
+                continue;
+            if (!__atomic_compare_exchange_n(&slots[i].tid, &expected, tid,
+                    0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+                continue;
+
+            __atomic_store_n(&slots[i].tail, 0, __ATOMIC_RELAXED);
+            __atomic_store_n(&slots[i].head, 0, __ATOMIC_RELEASE);
+            slots[i].dropped = 0;
+
+            local.gen = rb_gen;
+            local.index = i;
+            pthread_setspecific(slot_key, &local);
+            setup_altstack();
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+    Producer side
+
+    Only the owner thread writes to its ring, so "head" needs no atomic
+    read-modify-write. When the ring is full the oldest records are
+    dropped by moving "tail" forward before they are overwritten.
+
+    "tail" is the sequence of a seqlock: the fence after its store orders
+    it before every store overwriting the records it dropped, and the
+    dumper reads it again after copying them, see dump().
+*/
+static char* reserve(struct pmt_rb_slot* slot, char* ring, size_t size) {
+    uint64_t head = slot->head;
+    uint64_t tail = slot->tail;
+    size_t pad_off = head & (ring_size - 1);
+    size_t left = ring_size - pad_off;
+    size_t off = pad_off;
+
+    /* Records never wrap. Pad the end of the ring instead. */
+    if (left < size) {
+        head += left;
+        off = 0;
+    }
+
+    while (head + size - tail > ring_size) {
+        size_t toff = tail & (ring_size - 1);
+
+        if (ring_size - toff < RECORD_HEADER_SIZE)
+            tail += ring_size - toff;
+        else
+            tail += ((struct pmt_rb_record*)(ring + toff))->size;
+    }
+    __atomic_store_n(&slot->tail, tail, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    if (off != pad_off && left >= RECORD_HEADER_SIZE) {
+        struct pmt_rb_record* pad = (struct pmt_rb_record*)(ring + pad_off);
+
+        pad->size = left;
+        pad->event = PMT_RB_PADDING;
+    }
+
+    /* Publish the padding, so the reader never sees a stale tail chunk */
+    __atomic_store_n(&slot->head, head, __ATOMIC_RELEASE);
+
+    return ring + off;
+}
+
+static char* begin_record(uint16_t event, size_t payload_size, struct pmt_rb_slot** slotp) {
+    size_t size = RECORD_ALIGN(RECORD_HEADER_SIZE + payload_size);
+    struct pmt_rb_record* rec;
+    struct pmt_rb_slot* slot;
+
+    if (local.gen != rb_gen || local.index < 0) {
+        if (claim_slot() < 0)
+            return NULL;
+    }
+    slot = &slots[local.index];
+
+    /* Drop the events of signal handlers interrupting a write */
+    if (local.busy || size > ring_size / 2) {
+        slot->dropped++;
+        return NULL;
+    }
+    local.busy = 1;
+
+    rec = (struct pmt_rb_record*)reserve(slot, rings + (size_t)local.index * ring_size, size);
+    rec->size = size;
+    rec->event = event;
+    rec->reserved = 0;
+    rec->tid = slot->tid;
+    rec->reserved2 = 0;
+    rec->timestamp = now_ns();
+
+    *slotp = slot;
+    return (char*)(rec + 1);
+}
+
+static void end_record(struct pmt_rb_slot* slot, char* rec_payload) {
+    struct pmt_rb_record* rec = (struct pmt_rb_record*)rec_payload - 1;
+
+    __atomic_store_n(&slot->head, slot->head + rec->size, __ATOMIC_RELEASE);
+    local.busy = 0;
+}
+
+static char* put_str(char* p, const char* str, size_t len) {
+    memcpy(p, str, len);
+    p[len] = '\0';
+    return p + len + 1;
+}
+
+static char* put_u32(char* p, uint32_t v) {
+    memcpy(p, &v, sizeof(v));
+    return p + sizeof(v);
+}
+
+static char* put_seq(char* p, const void* data, uint32_t count, size_t elem_size) {
+    p = put_u32(p, count);
+    memcpy(p, data, count * elem_size);
+    return p + count * elem_size;
+}
+
+void pmt_rb_payload(uint16_t event, const char* cat, const char* payload) {
+    size_t cat_len = strlen(cat);
+    size_t payload_len = strlen(payload);
+    struct pmt_rb_slot* slot;
+    char* p = begin_record(event, cat_len + payload_len + 2, &slot);
+    char* start = p;
+
+    if (!p)
+        return;
+
+    p = put_str(p, cat, cat_len);
+    put_str(p, payload, payload_len);
+    end_record(slot, start);
+}
+
+void pmt_rb_name_payload(uint16_t event, const char* cat, const char* name, const char* payload) {
+    size_t cat_len = strlen(cat);
+    size_t name_len = strlen(name);
+    size_t payload_len = strlen(payload);
+    struct pmt_rb_slot* slot;
+    char* p = begin_record(event, cat_len + name_len + payload_len + 3, &slot);
+    char* start = p;
+
+    if (!p)
+        return;
+
+    p = put_str(p, cat, cat_len);
+    p = put_str(p, name, name_len);
+    put_str(p, payload, payload_len);
+    end_record(slot, start);
+}
+
+void pmt_rb_kv(uint16_t event, uint32_t cat_id, uint32_t name_id, uint32_t fmt_id,
+        const unsigned char* types, const int64_t* values, unsigned int count,
+        const char* text, size_t text_len) {
+    struct pmt_rb_slot* slot;
+    char* p = begin_record(event,
+        3 * sizeof(uint32_t) + 3 * sizeof(uint32_t) + count * (1 + sizeof(int64_t)) + text_len,
+        &slot);
+    char* start = p;
+
+    if (!p)
+        return;
+
+    p = put_u32(p, cat_id);
+    if (event != PMT_RB_LOG_KV)
+        p = put_u32(p, name_id);
+    p = put_u32(p, fmt_id);
+    p = put_seq(p, types, count, 1);
+    p = put_seq(p, values, count, sizeof(int64_t));
+    put_seq(p, text, text_len, 1);
+    end_record(slot, start);
+}
+
+void pmt_rb_id_string(uint16_t event, uint32_t id, const char* str) {
+    size_t len = strlen(str);
+    struct pmt_rb_slot* slot;
+    char* p = begin_record(event, sizeof(uint32_t) + len + 1, &slot);
+    char* start = p;
+
+    if (!p)
+        return;
+
+    p = put_u32(p, id);
+    put_str(p, str, len);
+    end_record(slot, start);
+}
+
+void pmt_rb_perflog(uint16_t event, const char* ctx, const char* msgid, uint64_t clock,
+        const char* payload) {
+    size_t ctx_len = strlen(ctx);
+    size_t msgid_len = strlen(msgid);
+    size_t payload_len = strlen(payload);
+    struct pmt_rb_slot* slot;
+    char* p = begin_record(event, ctx_len + msgid_len + sizeof(clock) + payload_len + 3, &slot);
+    char* start = p;
+
+    if (!p)
+        return;
+
+    p = put_str(p, ctx, ctx_len);
+    p = put_str(p, msgid, msgid_len);
+    memcpy(p, &clock, sizeof(clock));
+    put_str(p + sizeof(clock), payload, payload_len);
+    end_record(slot, start);
+}
+
+void pmt_rb_u64(uint16_t event, const uint64_t* values, unsigned int count) {
+    struct pmt_rb_slot* slot;
+    char* p = begin_record(event, count * sizeof(uint64_t), &slot);
+
+    if (!p)
+        return;
+
+    memcpy(p, values, count * sizeof(uint64_t));
+    end_record(slot, p);
+}
+
+void pmt_rb_ids_u64(uint16_t event, uint32_t cat_id, uint32_t name_id,
+        const uint64_t* values, unsigned int count) {
+    struct pmt_rb_slot* slot;
+    char* p = begin_record(event, 2 * sizeof(uint32_t) + count * sizeof(uint64_t), &slot);
+    char* start = p;
+
+    if (!p)
+        return;
+
+    p = put_u32(p, cat_id);
+    p = put_u32(p, name_id);
+    memcpy(p, values, count * sizeof(uint64_t));
+    end_record(slot, start);
+}
+
+/*
+    Dumper
+
+    Copies every ring to dump_buf and writes it out with async-signal-safe
+    calls only. The owner thread may still be writing, so the tail is read
+    again after the copy and the records overwritten meanwhile are skipped.
+    The acquire fence pairs with the release fence of reserve(): if the
+    copy saw any byte of an overwrite, the second read sees its tail.
+*/
+static int write_all(int fd, const void* buf, size_t len) {
+    const char* p = buf;
+
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+
+        if (n <= 0)
+            return -1;
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+struct def_writer {
+    int fd;
+    size_t len;
+    uint64_t total;
+    int error;
+};
+
+static void flush_defs(struct def_writer* w) {
+    if (w->len > 0 && write_all(w->fd, dump_buf, w->len) < 0)
+        w->error = 1;
+    w->len = 0;
+}
+
+static void put_def(uint32_t id, const char* str, void* arg) {
+    struct def_writer* w = arg;
+    size_t len = strlen(str);
+    size_t size = RECORD_ALIGN(RECORD_HEADER_SIZE + sizeof(uint32_t) + len + 1);
+    struct pmt_rb_record* rec;
+    char* p;
+
+    if (w->error || size > ring_size)
+        return;
+    if (w->len + size > ring_size)
+        flush_defs(w);
+
+    rec = (struct pmt_rb_record*)(dump_buf + w->len);
+    memset(rec, 0, size);
+    rec->size = size;
+    rec->event = PMT_RB_STRING_DEF;
+    p = put_u32((char*)(rec + 1), id);
+    put_str(p, str, len);
+
+    w->len += size;
+    w->total += size;
+}
+
+/*
+ * The string_def events of a ring may have been overwritten already,
+ * so all the interned strings follow the rings as a last pseudo ring
+ * (tid 0), in which records never wrap.
+ */
+static void dump_defs(int fd) {
+    struct def_writer w = { fd, 0, 0, 0 };
+    struct pmt_rb_slot defs;
+    off_t start = lseek(fd, 0, SEEK_CUR);
+
+    memset(&defs, 0, sizeof(defs));
+    if (start < 0 || write_all(fd, &defs, sizeof(defs)) < 0)
+        return;
+
+    pmt_intern_foreach(put_def, &w);
+    flush_defs(&w);
+
+    /* Now the size is known */
+    defs.head = w.total;
+    if (lseek(fd, start, SEEK_SET) == start)
+        write_all(fd, &defs, sizeof(defs));
+}
+
+static void dump(void) {
+    int expected = 0;
+    uint32_t i;
+    int fd;
+
+    if (!segment || !__atomic_compare_exchange_n(&dumping, &expected, 1,
+            0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        return;
+
+    fd = open(dump_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        goto out;
+
+    if (write_all(fd, header, sizeof(*header)) < 0)
+        goto close;
+
+    for (i = 0; i < slot_count; i++) {
+        struct pmt_rb_slot copy = slots[i];
+        const char* ring = rings + (size_t)i * ring_size;
+        uint64_t head = __atomic_load_n(&slots[i].head, __ATOMIC_ACQUIRE);
+        uint64_t tail = __atomic_load_n(&slots[i].tail, __ATOMIC_ACQUIRE);
+        uint64_t pos;
+        uint64_t new_tail;
+
+        if (copy.tid == 0 || head == tail)
+            continue;
+
+        for (pos = tail; pos < head; ) {
+            size_t off = pos & (ring_size - 1);
+            size_t len = ring_size - off;
+
+            if (len > head - pos)
+                len = head - pos;
+            memcpy(dump_buf + (pos - tail), ring + off, len);
+            pos += len;
+        }
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        new_tail = __atomic_load_n(&slots[i].tail, __ATOMIC_RELAXED);
+        if (new_tail >= head)
+            continue;
+        if (new_tail < tail)
+            new_tail = tail;
+
+        copy.tail = new_tail;
+        copy.head = head;
+        if (write_all(fd, &copy, sizeof(copy)) < 0 ||
+                write_all(fd, dump_buf + (new_tail - tail), head - new_tail) < 0)
+            goto close;
+    }
+
+    dump_defs(fd);
+
+close:
+    close(fd);
+out:
+    __atomic_store_n(&dumping, 0, __ATOMIC_RELEASE);
+}
+
+static void dump_handler(int sig) {
+    dump();
+}
+
+/* shm_unlink() is only unlink() of the /dev/shm path, which is async-signal-safe */
+static void unlink_segment(void) {
+    if (shm_name[0] != '\0')
+        shm_unlink(shm_name);
+    shm_name[0] = '\0';
+}
+
+/*
+ * Dump, then hand the signal over to the previous action: call its
+ * handler, or remove the segment and return so that a fault happens
+ * again with the default action. Signals sent by a process (si_code <= 0)
+ * are sent again.
+ */
+static void crash_handler(int sig, siginfo_t* info, void* ctx) {
+    struct sigaction* old = NULL;
+    unsigned int i;
+
+    dump();
+
+    for (i = 0; i < CRASH_SIGNAL_COUNT; i++) {
+        if (crash_signals[i] == sig) {
+            old = &old_actions[i];
+            break;
+        }
+    }
+    if (old == NULL)
+        return;
+
+    sigaction(sig, old, NULL);
+    if (old->sa_handler == SIG_DFL || old->sa_handler == SIG_IGN) {
+        /* Dying, and atexit() will not run */
+        unlink_segment();
+        if (info->si_code <= 0)
+            raise(sig);
+    } else if (old->sa_flags & SA_SIGINFO) {
+        old->sa_sigaction(sig, info, ctx);
+    } else {
+        old->sa_handler(sig);
+    }
+}
+
+static void install_handlers(void) {
+    struct sigaction sa;
+    struct sigaction old;
+    unsigned int i;
+
+    memset(&sa, 0, sizeof(sa));
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+
+    /* Leave the signal alone when the application uses it */
+    if (dump_signal > 0 && sigaction(dump_signal, NULL, &old) == 0 &&
+            old.sa_handler == SIG_DFL) {
+        sa.sa_handler = dump_handler;
+        sigaction(dump_signal, &sa, NULL);
+    }
+
+    if (!crash_dumps)
+        return;
+
+    /* On the signal stack of the thread, if any, for stack overflows */
+    sa.sa_sigaction = crash_handler;
+    sa.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    for (i = 0; i < CRASH_SIGNAL_COUNT; i++)
+        sigaction(crash_signals[i], &sa, &old_actions[i]);
+}
+
+/*
+    Initialization
+*/
+/*
+ * The segment stays named /dev/shm/pmtrace-<pid> while the process runs,
+ * so that pmtrace_rb_reader.py can read the rings live. It is unlinked at
+ * exit and after a crash dump; the reader removes the segments of killed
+ * processes with --clean. Forked children, which often exec or _exit
+ * without running atexit(), keep their rings in anonymous memory.
+ */
+static void* map_segment(size_t size, int named) {
+    void* addr;
+    int fd;
+
+    shm_name[0] = '\0';
+    if (named) {
+        snprintf(shm_name, sizeof(shm_name), "/pmtrace-%d", (int)getpid());
+        fd = shm_open(shm_name, O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd >= 0) {
+            addr = MAP_FAILED;
+            if (ftruncate(fd, size) == 0)
+                addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            close(fd);
+            if (addr != MAP_FAILED)
+                return addr;
+            shm_unlink(shm_name);
+        }
+        shm_name[0] = '\0';
+    }
+
+    /* No /dev/shm. The rings are still available to the dumper. */
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    return addr != MAP_FAILED ? addr : NULL;
+}
+
+static int create_segment(int named) {
+    const char* path = getenv("PMTRACE_RB_DUMP");
+    size_t slots_off = sizeof(struct pmt_rb_header);
+    size_t rings_off = slots_off + slot_count * sizeof(struct pmt_rb_slot);
+
+    segment_size = rings_off + (size_t)slot_count * ring_size;
+    segment = map_segment(segment_size, named);
+    if (!segment)
+        return -1;
+
+    dump_buf = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (dump_buf == MAP_FAILED) {
+        munmap(segment, segment_size);
+        segment = NULL;
+        return -1;
+    }
+
+    header = (struct pmt_rb_header*)segment;
+    slots = (struct pmt_rb_slot*)(segment + slots_off);
+    rings = segment + rings_off;
+
+    header->magic = PMT_RB_MAGIC;
+    header->version = PMT_RB_VERSION;
+    header->slot_count = slot_count;
+    header->ring_size = ring_size;
+    header->pid = getpid();
+
+    if (path)
+        snprintf(dump_path, sizeof(dump_path), "%s", path);
+    else
+        snprintf(dump_path, sizeof(dump_path), "/tmp/pmtrace-%d.rb", (int)getpid());
+
+    __atomic_add_fetch(&rb_gen, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void atfork_child(void) {
+    /* The segment is shared with the parent. Give the child its own. */
+    pmt_rb_state = 0;
+    if (dump_buf)
+        munmap(dump_buf, ring_size);
+    dump_buf = NULL;
+    if (segment)
+        munmap(segment, segment_size);
+    segment = NULL;
+
+    if (create_segment(0) == 0)
+        pmt_rb_state = 1;
+}
+
+void pmt_rb_init(void) {
+    uint32_t size_kb = env_u32("PMTRACE_RB_SIZE_KB", DEFAULT_RING_SIZE_KB);
+
+    slot_count = env_u32("PMTRACE_RB_THREADS", DEFAULT_SLOT_COUNT);
+    if (size_kb == 0 || slot_count == 0)
+        return;
+    if (slot_count > MAX_SLOT_COUNT)
+        slot_count = MAX_SLOT_COUNT;
+
+    ring_size = 4096;
+    while (ring_size < size_kb * 1024 && ring_size < (1U << 30))
+        ring_size <<= 1;
+
+    if (pthread_key_create(&slot_key, release_slot) != 0)
+        return;
+    crash_dumps = getenv("PMTRACE_RB_DUMP") != NULL;
+    dump_signal = (int)env_u32("PMTRACE_RB_SIGNAL", 0);
+    if (create_segment(1) < 0)
+        return;
+
+    atexit(unlink_segment);
+    install_handlers();
+    pthread_atfork(NULL, NULL, atfork_child);
+    pmt_rb_state = 1;
+}
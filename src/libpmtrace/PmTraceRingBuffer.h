@@ -0,0 +1,178 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PMTRACE_RINGBUFFER_H
+#define __PMTRACE_RINGBUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Standalone ring buffer backend.
+ *
+ * Used when libPmTrace is built without lttng-ust. Each thread writes its
+ * events to its own ring in a shared memory segment (/dev/shm/pmtrace-<pid>,
+ * removed at exit), overwriting the oldest events when the ring is full.
+ * files/scripts/pmtrace_rb_reader.py decodes the segment of a running
+ * process, and the dump files below.
+ *
+ * The rings are dumped to /tmp/pmtrace-<pid>.rb, or to PMTRACE_RB_DUMP:
+ * on the signal number PMTRACE_RB_SIGNAL when it is set (and the
+ * application does not handle that signal), and when the process crashes
+ * if PMTRACE_RB_DUMP is set.
+ *
+ * PMTRACE_RB_SIZE_KB and PMTRACE_RB_THREADS set the size of a ring
+ * (default 64, rounded up to a power of 2) and the number of rings
+ * (default 64).
+ *
+ * The segment is a struct pmt_rb_header, then slot_count struct
+ * pmt_rb_slot, then slot_count rings of ring_size bytes.
+ *
+ * Dump file layout, all integers in host byte order:
+ *   struct pmt_rb_header
+ *   for each ring in use:
+ *     struct pmt_rb_slot (tail and head of the dumped data)
+ *     records from tail to head, unwrapped
+ *   struct pmt_rb_slot with tid 0 and tail 0
+ *     PMT_RB_STRING_DEF records of all the interned strings
+ *
+ * A record is a struct pmt_rb_record followed by the fields of the
+ * LTTng event of the same name, in the order of PmTraceProvider.h:
+ * strings are NUL-terminated, integers are native, and sequences are
+ * a uint32_t length followed by the elements. Records are 8-byte
+ * aligned. PMT_RB_PADDING records and tails shorter than a record
+ * header are skipped.
+ */
+
+#define PMT_RB_MAGIC    0x52544d50  /* "PMTR" */
+#define PMT_RB_VERSION  1
+
+enum {
+    PMT_RB_PADDING = 0,
+    PMT_RB_LOG,
+    PMT_RB_BLOCK_ENTRY,
+    PMT_RB_BLOCK_EXIT,
+    PMT_RB_MARKER,
+    PMT_RB_PERFLOG,
+    PMT_RB_LOG_KV,
+    PMT_RB_BLOCK_ENTRY_KV,
+    PMT_RB_BLOCK_EXIT_KV,
+    PMT_RB_MARKER_KV,
+    PMT_RB_STRING_DEF,
+    PMT_RB_BLOCK_COMPLETE,
+    PMT_RB_BLOCK_SUMMARY,
+    PMT_RB_PERFLOG_CLOCK,
+    PMT_RB_PAYLOAD_OVERSIZE
+};
+
+struct pmt_rb_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t ring_size;
+    int32_t pid;
+    uint32_t reserved[11];
+};
+
+struct pmt_rb_slot {
+    int32_t tid;
+    uint32_t dropped;
+    uint64_t tail;
+    uint64_t head;
+    uint64_t reserved[5];
+};
+
+struct pmt_rb_record {
+    uint32_t size;
+    uint16_t event;
+    uint16_t reserved;
+    int32_t tid;
+    uint32_t reserved2;
+    uint64_t timestamp;
+};
+
+extern int pmt_rb_state __attribute__((visibility("hidden")));
+
+void pmt_rb_init(void) __attribute__((visibility("hidden")));
+
+void pmt_rb_payload(uint16_t event, const char* cat, const char* payload)
+    __attribute__((visibility("hidden")));
+void pmt_rb_name_payload(uint16_t event, const char* cat, const char* name, const char* payload)
+    __attribute__((visibility("hidden")));
+void pmt_rb_kv(uint16_t event, uint32_t cat_id, uint32_t name_id, uint32_t fmt_id,
+        const unsigned char* types, const int64_t* values, unsigned int count,
+        const char* text, size_t text_len)
+    __attribute__((visibility("hidden")));
+void pmt_rb_id_string(uint16_t event, uint32_t id, const char* str)
+    __attribute__((visibility("hidden")));
+void pmt_rb_perflog(uint16_t event, const char* ctx, const char* msgid, uint64_t clock,
+        const char* payload)
+    __attribute__((visibility("hidden")));
+void pmt_rb_u64(uint16_t event, const uint64_t* values, unsigned int count)
+    __attribute__((visibility("hidden")));
+void pmt_rb_ids_u64(uint16_t event, uint32_t cat_id, uint32_t name_id,
+        const uint64_t* values, unsigned int count)
+    __attribute__((visibility("hidden")));
+
+/*
+    tracepoint_enabled/do_tracepoint of the events of PmTraceProvider.h
+*/
+#define tracepoint_enabled(provider, name) \
+    __builtin_expect(pmt_rb_state, 0)
+#define do_tracepoint(provider, name, ...) \
+    _PMT_RB_##name(__VA_ARGS__)
+
+#define _PMT_RB_log(...) \
+    pmt_rb_payload(PMT_RB_LOG, __VA_ARGS__)
+#define _PMT_RB_block_entry(...) \
+    pmt_rb_name_payload(PMT_RB_BLOCK_ENTRY, __VA_ARGS__)
+#define _PMT_RB_block_exit(...) \
+    pmt_rb_name_payload(PMT_RB_BLOCK_EXIT, __VA_ARGS__)
+#define _PMT_RB_marker(...) \
+    pmt_rb_name_payload(PMT_RB_MARKER, __VA_ARGS__)
+#define _PMT_RB_perflog(...) \
+    pmt_rb_name_payload(PMT_RB_PERFLOG, __VA_ARGS__)
+#define _PMT_RB_log_kv(cat_id, ...) \
+    pmt_rb_kv(PMT_RB_LOG_KV, cat_id, 0, __VA_ARGS__)
+#define _PMT_RB_block_entry_kv(...) \
+    pmt_rb_kv(PMT_RB_BLOCK_ENTRY_KV, __VA_ARGS__)
+#define _PMT_RB_block_exit_kv(...) \
+    pmt_rb_kv(PMT_RB_BLOCK_EXIT_KV, __VA_ARGS__)
+#define _PMT_RB_marker_kv(...) \
+    pmt_rb_kv(PMT_RB_MARKER_KV, __VA_ARGS__)
+#define _PMT_RB_string_def(...) \
+    pmt_rb_id_string(PMT_RB_STRING_DEF, __VA_ARGS__)
+#define _PMT_RB_perflog_clock(...) \
+    pmt_rb_perflog(PMT_RB_PERFLOG_CLOCK, __VA_ARGS__)
+#define _PMT_RB_block_complete(cat_id, name_id, ...) \
+    _PMT_RB_IDS_U64(PMT_RB_BLOCK_COMPLETE, cat_id, name_id, __VA_ARGS__)
+#define _PMT_RB_block_summary(cat_id, name_id, ...) \
+    _PMT_RB_IDS_U64(PMT_RB_BLOCK_SUMMARY, cat_id, name_id, __VA_ARGS__)
+
+#define _PMT_RB_payload_oversize(size, count) \
+    do { \
+        const uint64_t _values[] = { size, count }; \
+        pmt_rb_u64(PMT_RB_PAYLOAD_OVERSIZE, _values, 2); \
+    } while(0)
+
+#define _PMT_RB_IDS_U64(event, cat_id, name_id, ...) \
+    do { \
+        const uint64_t _values[] = { __VA_ARGS__ }; \
+        pmt_rb_ids_u64(event, cat_id, name_id, _values, \
+            sizeof(_values) / sizeof(_values[0])); \
+    } while(0)
+
+#endif // __PMTRACE_RINGBUFFER_H
@@ -0,0 +1,228 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "PmTraceSampling.h"
+
+#define SAMPLING_CONF       "/etc/pmtrace/sampling.conf"
+#define MAX_RULES           32
+#define MAX_CATEGORY_LEN    64
+#define BURST_NS            1000000000ULL
+
+/* Must be a power of 2 */
+#define RULE_CACHE_SIZE     8
+
+/* Block entries whose decision is kept for their exit, per thread */
+#define MAX_BLOCK_DEPTH     64
+
+struct sampling_rule {
+    char cat[MAX_CATEGORY_LEN];
+    uint32_t ratio;
+    /* Token bucket as a theoretical arrival time, 0 if not limited */
+    uint64_t interval_ns;
+    uint64_t tat;
+};
+
+/*
+ * Rule of a category, by the address of the category string. The text
+ * is kept to check a hit, as the address may be reused for another one.
+ */
+struct rule_cache_entry {
+    const char* cat;
+    struct sampling_rule* rule;
+    char text[MAX_CATEGORY_LEN];
+};
+
+int pmt_sampling_active;
+
+static struct sampling_rule rules[MAX_RULES];
+static int rule_count;
+static struct sampling_rule* default_rule;
+
+static __thread int32_t countdown[MAX_RULES];
+static __thread struct rule_cache_entry rule_cache[RULE_CACHE_SIZE];
+
+/* Decisions of the open blocks: bit N for the block at depth N */
+static __thread uint64_t block_kept;
+static __thread uint32_t block_depth;
+
+static void add_rule(const char* str, size_t len) {
+    struct sampling_rule* rule;
+    char buf[MAX_CATEGORY_LEN + 32];
+    char* sep;
+    unsigned long rate = 0;
+
+    while (len > 0 && (*str == ' ' || *str == '\t')) {
+        str++;
+        len--;
+    }
+    if (len == 0 || *str == '#' || len >= sizeof(buf) || rule_count == MAX_RULES)
+        return;
+
+    memcpy(buf, str, len);
+    buf[len] = '\0';
+
+    sep = strchr(buf, ':');
+    if (sep == NULL || sep == buf || sep - buf >= MAX_CATEGORY_LEN) {
+        fprintf(stderr, "pmtrace: invalid sampling rule '%s'\n", buf);
+        return;
+    }
+    *sep++ = '\0';
+
+    rule = &rules[rule_count++];
+    strcpy(rule->cat, buf);
+    rule->ratio = strtoul(sep, &sep, 10);
+    if (rule->ratio == 0)
+        rule->ratio = 1;
+    if (*sep == ':')
+        rate = strtoul(sep + 1, NULL, 10);
+    rule->interval_ns = rate ? 1000000000ULL / rate : 0;
+
+    if (strcmp(rule->cat, "*") == 0)
+        default_rule = rule;
+}
+
+static void parse_rules(const char* str, char delim) {
+    const char* end;
+
+    for (; *str; str = *end ? end + 1 : end) {
+        end = strchr(str, delim);
+        if (end == NULL)
+            end = str + strlen(str);
+        add_rule(str, end - str);
+    }
+}
+
+void pmt_sampling_init(void) {
+    const char* env = getenv("PMTRACE_SAMPLING");
+    FILE* fp;
+    char line[256];
+    int i;
+
+    if (env) {
+        parse_rules(env, ',');
+    } else if ((fp = fopen(SAMPLING_CONF, "r")) != NULL) {
+        while (fgets(line, sizeof(line), fp))
+            parse_rules(line, '\n');
+        fclose(fp);
+    }
+
+    for (i = 0; i < rule_count; i++) {
+        if (rules[i].ratio > 1 || rules[i].interval_ns)
+            pmt_sampling_active = 1;
+    }
+}
+
+static struct sampling_rule* find_rule(const char* cat) {
+    int i;
+
+    for (i = 0; i < rule_count; i++) {
+        if (strcmp(rules[i].cat, cat) == 0)
+            return &rules[i];
+    }
+    return default_rule;
+}
+
+static struct sampling_rule* lookup_rule(const char* cat) {
+    struct rule_cache_entry* entry;
+    size_t len;
+
+    if (cat == NULL)
+        return default_rule;
+
+    entry = &rule_cache[((uintptr_t)cat >> 3) & (RULE_CACHE_SIZE - 1)];
+    if (entry->cat == cat && strcmp(entry->text, cat) == 0)
+        return entry->rule;
+
+    /* Longer categories match no rule, and are not cached */
+    len = strnlen(cat, MAX_CATEGORY_LEN);
+    if (len == MAX_CATEGORY_LEN)
+        return default_rule;
+
+    entry->cat = cat;
+    entry->rule = find_rule(cat);
+    memcpy(entry->text, cat, len + 1);
+    return entry->rule;
+}
+
+/* The rate limits allow a burst of a second: the coarse clock will do */
+static uint64_t now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int take_token(struct sampling_rule* rule, uint64_t now) {
+    uint64_t tat, new_tat;
+
+    tat = __atomic_load_n(&rule->tat, __ATOMIC_RELAXED);
+    do {
+        new_tat = (tat > now ? tat : now) + rule->interval_ns;
+        if (new_tat - now > BURST_NS)
+            return 0;
+    } while (!__atomic_compare_exchange_n(&rule->tat, &tat, new_tat,
+            1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    return 1;
+}
+
+int pmt_sample(const char* cat) {
+    struct sampling_rule* rule = lookup_rule(cat);
+
+    if (rule == NULL)
+        return 1;
+
+    if (rule->ratio > 1) {
+        int32_t* count = &countdown[rule - rules];
+
+        if (--*count > 0)
+            return 0;
+        *count = rule->ratio;
+    }
+
+    if (rule->interval_ns)
+        return take_token(rule, now_ns());
+    return 1;
+}
+
+int pmt_sample_entry(const char* cat) {
+    int kept = pmt_sample(cat);
+
+    if (block_depth < MAX_BLOCK_DEPTH) {
+        if (kept)
+            block_kept |= 1ULL << block_depth;
+        else
+            block_kept &= ~(1ULL << block_depth);
+    }
+    block_depth++;
+    return kept;
+}
+
+int pmt_sample_exit(void) {
+    /* Exits without an entry, or too deep to remember, are kept */
+    if (block_depth == 0)
+        return 1;
+    block_depth--;
+    if (block_depth >= MAX_BLOCK_DEPTH)
+        return 1;
+    return (block_kept >> block_depth) & 1;
+}
@@ -0,0 +1,62 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PMTRACE_SAMPLING_H
+#define __PMTRACE_SAMPLING_H
+
+/**
+ * @brief Per-category sampling and rate limiting.
+ *
+ * Rules are read from PMTRACE_SAMPLING (comma separated) or, when it is
+ * not set, from /etc/pmtrace/sampling.conf (one per line, '#' comments):
+ *
+ *   <category>:<ratio>[:<rate>]
+ *
+ * keeps 1 in <ratio> events of the category and at most <rate> events
+ * per second (0 for no limit). The category "*" applies to categories
+ * without their own rule. Each thread counts down to its next kept
+ * event of a rule, so every <ratio>th event of a thread is recorded.
+ */
+extern int pmt_sampling_active __attribute__((visibility("hidden")));
+
+void pmt_sampling_init(void) __attribute__((visibility("hidden")));
+
+/**
+ * @brief Return non-zero if an event of the category is to be recorded.
+ */
+int pmt_sample(const char* cat) __attribute__((visibility("hidden")));
+
+/**
+ * @brief pmt_sample for block entry/exit pairs.
+ *
+ * The entry is sampled like the other events, and the decision is kept
+ * on a per-thread stack for its exit, so a block is recorded as a whole
+ * or not at all. The rate limit applies to the entries only. Blocks must
+ * be exited in the reverse order of their entries, on the same thread;
+ * the exits of blocks nested more than 64 deep, and exits without an
+ * entry, are recorded and are to be dropped by the readers.
+ */
+int pmt_sample_entry(const char* cat) __attribute__((visibility("hidden")));
+int pmt_sample_exit(void) __attribute__((visibility("hidden")));
+
+#define PMT_SAMPLED(cat) \
+    (!pmt_sampling_active || pmt_sample(cat))
+#define PMT_SAMPLED_ENTRY(cat) \
+    (!pmt_sampling_active || pmt_sample_entry(cat))
+#define PMT_SAMPLED_EXIT() \
+    (!pmt_sampling_active || pmt_sample_exit())
+
+#endif // __PMTRACE_SAMPLING_H
@@ -0,0 +1,153 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "AhoCorasick.h"
+
+#include <cstring>
+#include <queue>
+
+AhoCorasick::AhoCorasick()
+: m_nclasses(1)
+{
+    memset(m_class, 0, sizeof(m_class));
+}
+
+uint32_t AhoCorasick::add(const string& pattern)
+{
+    m_patterns.push_back(pattern);
+    return m_patterns.size() - 1;
+}
+
+void AhoCorasick::build()
+{
+    vector<int32_t> fail;
+    queue<int32_t> pending;
+
+    // Byte classes: 0 for bytes that are in no pattern
+    memset(m_class, 0, sizeof(m_class));
+    m_nclasses = 1;
+    for(size_t i = 0; i < m_patterns.size(); i++)
+    {
+        for(size_t j = 0; j < m_patterns[i].size(); j++)
+        {
+            uint8_t c = m_patterns[i][j];
+
+            if(m_class[c] == 0)
+                m_class[c] = m_nclasses++;
+        }
+    }
+
+    // The trie, with -1 for missing edges
+    m_next.assign(m_nclasses, -1);
+    m_out.assign(1, vector<uint32_t>());
+    for(size_t i = 0; i < m_patterns.size(); i++)
+    {
+        int32_t state = 0;
+
+        for(size_t j = 0; j < m_patterns[i].size(); j++)
+        {
+            size_t c = m_class[(uint8_t) m_patterns[i][j]];
+
+            if(m_next[state * m_nclasses + c] < 0)
+            {
+                m_next[state * m_nclasses + c] = m_out.size();
+                m_next.resize(m_next.size() + m_nclasses, -1);
+                m_out.push_back(vector<uint32_t>());
+            }
+            state = m_next[state * m_nclasses + c];
+        }
+
+        // The empty pattern would match everywhere; it is left to the caller
+        if(state != 0)
+            m_out[state].push_back(i);
+    }
+
+    // Failure links in breadth first order, then the missing edges follow them
+    fail.assign(m_out.size(), 0);
+    for(size_t c = 0; c < m_nclasses; c++)
+    {
+        int32_t next = m_next[c];
+
+        if(next < 0)
+        {
+            m_next[c] = 0;
+        }
+        else if(next > 0)
+        {
+            fail[next] = 0;
+            pending.push(next);
+        }
+    }
+
+    while(!pending.empty())
+    {
+        int32_t state = pending.front();
+
+        pending.pop();
+        for(size_t c = 0; c < m_nclasses; c++)
+        {
+            int32_t next = m_next[state * m_nclasses + c];
+
+            if(next < 0)
+            {
+                m_next[state * m_nclasses + c] = m_next[fail[state] * m_nclasses + c];
+                continue;
+            }
+
+            fail[next] = m_next[fail[state] * m_nclasses + c];
+            m_out[next].insert(m_out[next].end(), m_out[fail[next]].begin(), m_out[fail[next]].end());
+            pending.push(next);
+        }
+    }
+}
+
+bool AhoCorasick::containsAny(const char *text, size_t len) const
+{
+    int32_t state = 0;
+
+    for(size_t i = 0; i < len; i++)
+    {
+        state = m_next[state * m_nclasses + m_class[(uint8_t) text[i]]];
+        if(!m_out[state].empty())
+            return true;
+    }
+    return false;
+}
+
+void AhoCorasick::findFirst(const char *text, size_t len, vector<pair<uint32_t, uint32_t> >& found) const
+{
+    int32_t state = 0;
+
+    found.clear();
+    for(size_t i = 0; i < len; i++)
+    {
+        state = m_next[state * m_nclasses + m_class[(uint8_t) text[i]]];
+
+        for(size_t j = 0; j < m_out[state].size(); j++)
+        {
+            uint32_t id = m_out[state][j];
+            size_t k;
+
+            for(k = 0; k < found.size(); k++)
+            {
+                if(found[k].first == id)
+                    break;
+            }
+            if(k == found.size())
+                found.push_back(make_pair(id, (uint32_t) (i + 1)));
+        }
+    }
+}
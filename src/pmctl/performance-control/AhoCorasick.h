@@ -0,0 +1,55 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _AHO_CORASICK_
+#define _AHO_CORASICK_
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// Finds many substrings in one pass over a text. The automaton is a full
+// DFA over the bytes that appear in the patterns; all other bytes share a
+// single class.
+class AhoCorasick
+{
+public:
+    AhoCorasick();
+
+    uint32_t add(const string& pattern);
+    void build();
+
+    size_t size() const { return m_patterns.size(); }
+    size_t length(uint32_t id) const { return m_patterns[id].size(); }
+
+    bool containsAny(const char *text, size_t len) const;
+
+    // Each pattern found in the text, once, with the end offset of its
+    // first occurrence. Patterns are listed in the order they are found.
+    void findFirst(const char *text, size_t len, vector<pair<uint32_t, uint32_t> >& found) const;
+
+private:
+    vector<string> m_patterns;
+
+    uint8_t m_class[256];
+    size_t m_nclasses;
+    vector<int32_t> m_next;             // state * m_nclasses + class
+    vector<vector<uint32_t> > m_out;    // patterns that end in each state
+};
+
+#endif
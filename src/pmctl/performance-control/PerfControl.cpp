@@ -15,6 +15,7 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "PerfControl.h"
+#include "PerfLogReport.h"
 
 const string PerfControl::MODULE_PERFLOG_REPORT     = "perflog-report";
 const string PerfControl::MODULE_MEMORY_PROFILE     = "memory-profile";
@@ -31,7 +32,7 @@ PerfControl::PerfControl(int argc, char ** argv)
     for(int i=0; i<argc; i++)
     {
         m_argv[i] = new char [strlen(argv[i])+1];
-        strncpy(m_argv[i], argv[i], strlen(argv[i]));
+        strcpy(m_argv[i], argv[i]);
     }
 
     for(int i=0; i < m_argc; i++)
@@ -58,7 +59,17 @@ bool PerfControl::execModule()
 {
     if(m_module == PerfControl::MODULE_PERFLOG_REPORT)
     {
-        if(!runModule(PerfControl::COMMAND_PERFLOG_REPORT))
+        PerfLogReport report(m_argc, m_argv, m_isDebug);
+
+        if(report.isNative())
+        {
+            if(!report.run())
+            {
+                cerr << "[ERROR] fail to run perflog-report\n";
+                return false;
+            }
+        }
+        else if(!runModule(PerfControl::COMMAND_PERFLOG_REPORT))
         {
             cerr << "[ERROR] fail to run perflog-report\n";
             return false;
@@ -0,0 +1,205 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PerfLogAnalyzer.h"
+
+PerfLogAnalyzer::PerfLogAnalyzer(const PerfLogConfig& config, const PerfLogTable& table)
+: m_config(config),
+  m_table(table)
+{
+}
+
+// The most frequent value, the first one seen on a tie
+uint32_t PerfLogAnalyzer::mostCommon(const vector<uint32_t>& ids)
+{
+    vector<pair<uint32_t, size_t> > counts;
+    size_t best = 0;
+
+    for(size_t i = 0; i < ids.size(); i++)
+    {
+        size_t j;
+
+        for(j = 0; j < counts.size(); j++)
+        {
+            if(counts[j].first == ids[i])
+                break;
+        }
+        if(j == counts.size())
+            counts.push_back(make_pair(ids[i], 0));
+        counts[j].second++;
+    }
+
+    for(size_t j = 1; j < counts.size(); j++)
+    {
+        if(counts[j].second > counts[best].second)
+            best = j;
+    }
+
+    return counts.empty() ? PerfLogTable::EMPTY_ID : counts[best].first;
+}
+
+string PerfLogAnalyzer::representative(const string& given, size_t first, size_t last, bool isType) const
+{
+    vector<uint32_t> ids;
+
+    if(!given.empty())
+        return given;
+
+    for(size_t i = first; i <= last; i++)
+        ids.push_back(isType ? m_table.typeId(i) : m_table.groupId(i));
+    return m_table.str(mostCommon(ids));
+}
+
+// The matching conditions of each row come from the compiled index.
+// Start conditions are recorded one by one, since a duplicated start is
+// checked against a single one.
+void PerfLogAnalyzer::indexMatches()
+{
+    const PerfLogMatcher& matcher = m_config.matcher();
+    size_t nconds = matcher.startCount();
+    size_t ncontexts = m_config.contexts().size();
+    vector<uint32_t> ids;
+
+    m_starts.clear();
+    m_startRows.assign(nconds, vector<uint32_t>());
+    m_endRows.assign(ncontexts, vector<uint32_t>());
+
+    for(size_t i = 0; i < m_table.size(); i++)
+    {
+        uint32_t lastStart = ncontexts;
+        uint32_t lastEnd = ncontexts;
+
+        matcher.match(m_table, i, ids);
+
+        // Ids are sorted, so each context comes up in one run
+        for(size_t k = 0; k < ids.size(); k++)
+        {
+            uint32_t ctx = matcher.context(ids[k]);
+
+            if(ids[k] < nconds)
+            {
+                if(ctx != lastStart)
+                {
+                    StartMatch match = { (uint32_t) i, ctx, ids[k] };
+
+                    m_starts.push_back(match);
+                    lastStart = ctx;
+                }
+                m_startRows[ids[k]].push_back(i);
+            }
+            else if(ctx != lastEnd)
+            {
+                m_endRows[ctx].push_back(i);
+                lastEnd = ctx;
+            }
+        }
+    }
+
+    m_windowEnd.assign(ncontexts, 0);
+    m_endCursor.assign(ncontexts, 0);
+    m_startCursor.assign(nconds, 0);
+}
+
+// The last end row of the context in [cur, the first row at limit)
+bool PerfLogAnalyzer::findLastEnd(size_t ctx, size_t cur, double limit, size_t& last)
+{
+    const vector<uint32_t>& rows = m_endRows[ctx];
+    size_t& end = m_windowEnd[ctx];
+    size_t& cursor = m_endCursor[ctx];
+
+    while(end < m_table.size() && m_table.clock(end) < limit)
+        end++;
+    while(cursor < rows.size() && rows[cursor] < end)
+        cursor++;
+
+    if(cursor == 0 || rows[cursor - 1] < cur)
+        return false;
+
+    last = rows[cursor - 1];
+    return true;
+}
+
+// Whether the start condition matches a row in (cur, last]
+bool PerfLogAnalyzer::hasStartAfter(size_t cond, size_t cur, size_t last)
+{
+    const vector<uint32_t>& rows = m_startRows[cond];
+    size_t& cursor = m_startCursor[cond];
+
+    while(cursor < rows.size() && rows[cursor] <= cur)
+        cursor++;
+
+    return cursor < rows.size() && rows[cursor] <= last;
+}
+
+// Gives the same sessions as analyze() of perf_log_viewer.py, which
+// rescans the window of each start. A session moves the cursor to its
+// end row, and the next context that matched the same start row begins
+// its window from there.
+PerfLogSessions PerfLogAnalyzer::analyze()
+{
+    const vector<PerfLogContext>& contexts = m_config.contexts();
+    PerfLogSessions sessions;
+    size_t next = 0;
+    size_t cur = 0;
+
+    indexMatches();
+
+    while(true)
+    {
+        size_t group;
+        size_t startCond;
+        double startClock;
+
+        while(next < m_starts.size() && m_starts[next].row < cur)
+            next++;
+        if(next == m_starts.size())
+            break;
+
+        // The contexts that matched this row, in the order of the config
+        cur = m_starts[next].row;
+        startClock = m_table.clock(cur);
+        startCond = m_starts[next].cond;
+        for(group = next; group < m_starts.size() && m_starts[group].row == m_starts[next].row; group++)
+            ;
+
+        for(size_t i = next; i < group; i++)
+        {
+            const PerfLogContext& ctx = contexts[m_starts[i].ctx];
+            double limit = startClock + ctx.allowedResponseMS / 1000;
+            PerfLogSession session;
+            size_t last;
+
+            if(!findLastEnd(m_starts[i].ctx, cur, limit, last))
+                continue;
+
+            if(hasStartAfter(startCond, cur, last))
+                continue;
+
+            session.first = cur;
+            session.count = last - cur + 1;
+            session.reprType = representative(ctx.reprType, cur, last, true);
+            session.reprGroup = representative(ctx.reprGroup, cur, last, false);
+            sessions.push_back(session);
+
+            cur = last;
+        }
+
+        next = group;
+        cur++;
+    }
+
+    return sessions;
+}
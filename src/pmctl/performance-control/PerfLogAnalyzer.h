@@ -0,0 +1,74 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _PERF_LOG_ANALYZER_
+#define _PERF_LOG_ANALYZER_
+
+#include "PerfLogConfig.h"
+
+// Rows [first, first + count) of the sorted table, from a start
+// condition to the last end condition within allowedResponseMS.
+struct PerfLogSession
+{
+    size_t first;
+    size_t count;
+    string reprType;
+    string reprGroup;
+};
+
+typedef vector<PerfLogSession> PerfLogSessions;
+
+// Finds the sessions in one pass over the table. The rows that match
+// each condition are indexed first, through PerfLogMatcher. Every context
+// then keeps a cursor on the end of its response window and on its last
+// end row, and every start condition keeps a cursor on its next row. Rows
+// are sorted by clock, so none of the cursors ever moves back.
+class PerfLogAnalyzer
+{
+public:
+    PerfLogAnalyzer(const PerfLogConfig& config, const PerfLogTable& table);
+
+    PerfLogSessions analyze();
+
+private:
+    // A row that matches at least one start condition of a context
+    struct StartMatch
+    {
+        uint32_t row;
+        uint32_t ctx;
+        uint32_t cond;  // the first start condition that matched
+    };
+
+    void indexMatches();
+    bool findLastEnd(size_t ctx, size_t cur, double limit, size_t& last);
+    bool hasStartAfter(size_t cond, size_t cur, size_t last);
+    string representative(const string& given, size_t first, size_t last, bool isType) const;
+
+    static uint32_t mostCommon(const vector<uint32_t>& ids);
+
+    const PerfLogConfig& m_config;
+    const PerfLogTable& m_table;
+
+    vector<StartMatch> m_starts;
+    vector<vector<uint32_t> > m_startRows;      // per start condition
+    vector<vector<uint32_t> > m_endRows;        // per context
+
+    vector<size_t> m_windowEnd;                 // per context, first row past the window
+    vector<size_t> m_endCursor;                 // per context, end rows before m_windowEnd
+    vector<size_t> m_startCursor;               // per start condition, rows up to the cursor
+};
+
+#endif
@@ -0,0 +1,112 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PerfLogConfig.h"
+
+#include "utils/Util.h"
+
+// A missing or null value is an empty string, like in PerfLogEntry
+static string getString(const JValue& obj, const char *key)
+{
+    if(!obj.hasKey(key) || !obj[key].isString())
+        return "";
+    return obj[key].asString();
+}
+
+static bool loadConditions(const JValue& arr, vector<PerfLogCondition>& conds)
+{
+    if(!arr.isArray())
+        return false;
+
+    for(ssize_t i = 0; i < arr.arraySize(); i++)
+    {
+        const JValue& obj = arr[i];
+        PerfLogCondition cond;
+
+        if(!obj.isObject())
+            return false;
+
+        cond.type = getString(obj, "PerfType");
+        cond.group = getString(obj, "PerfGroup");
+        cond.msgid = getString(obj, "msgid");
+
+        if(obj.hasKey("requiredStrings"))
+        {
+            const JValue& strs = obj["requiredStrings"];
+
+            if(!strs.isArray())
+                return false;
+            for(ssize_t j = 0; j < strs.arraySize(); j++)
+                cond.requiredStrings.push_back(strs[j].asString());
+        }
+
+        conds.push_back(cond);
+    }
+    return true;
+}
+
+bool PerfLogConfig::load(const string& file)
+{
+    JValue conf = parseFile(file.c_str());
+
+    if(!conf.isObject() || !conf.hasKey("contexts") || !conf["contexts"].isArray())
+    {
+        cerr << "[ERROR] (PerfLogConfig) no contexts in " << file << endl;
+        return false;
+    }
+
+    const JValue& ctxs = conf["contexts"];
+
+    m_contexts.clear();
+    for(ssize_t i = 0; i < ctxs.arraySize(); i++)
+    {
+        const JValue& obj = ctxs[i];
+        PerfLogContext ctx;
+
+        if(!obj.isObject() || !obj.hasKey("allowedResponseMS") || !obj["allowedResponseMS"].isNumber())
+        {
+            cerr << "[ERROR] (PerfLogConfig) wrong context[" << i << "] in " << file << endl;
+            return false;
+        }
+
+        ctx.description = getString(obj, "description");
+        ctx.reprType = getString(obj, "PerfType");
+        ctx.reprGroup = getString(obj, "PerfGroup");
+        ctx.allowedResponseMS = obj["allowedResponseMS"].asNumber<double>();
+
+        if(!loadConditions(obj["startConditions"], ctx.starts) ||
+           !loadConditions(obj["endConditions"], ctx.ends))
+        {
+            cerr << "[ERROR] (PerfLogConfig) wrong conditions in context[" << i << "] of " << file << endl;
+            return false;
+        }
+
+        m_contexts.push_back(ctx);
+    }
+
+    m_matcher.compile(m_contexts);
+    return true;
+}
+
+bool PerfLogConfig::isCandidate(const char *line, size_t len) const
+{
+    return m_matcher.isCandidate(line, len);
+}
+
+bool PerfLogConfig::isInConditions(const PerfLogTable& table, size_t i) const
+{
+    return m_matcher.hasMatch(table, i);
+}
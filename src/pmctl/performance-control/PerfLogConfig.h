@@ -0,0 +1,57 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _PERF_LOG_CONFIG_
+#define _PERF_LOG_CONFIG_
+
+#include "PerfLogMatcher.h"
+
+// A start or end condition of perf-log-viewer-conf.json. "*" matches
+// any value. requiredStrings must appear in the line in that order.
+struct PerfLogCondition
+{
+    string type;
+    string group;
+    string msgid;
+    vector<string> requiredStrings;
+};
+
+struct PerfLogContext
+{
+    string description;
+    string reprType;
+    string reprGroup;
+    double allowedResponseMS;
+    vector<PerfLogCondition> starts;
+    vector<PerfLogCondition> ends;
+};
+
+class PerfLogConfig
+{
+public:
+    bool load(const string& file);
+
+    bool isInConditions(const PerfLogTable& table, size_t i) const;
+    bool isCandidate(const char *line, size_t len) const;
+    const vector<PerfLogContext>& contexts() const { return m_contexts; }
+    const PerfLogMatcher& matcher() const { return m_matcher; }
+
+private:
+    vector<PerfLogContext> m_contexts;
+    PerfLogMatcher m_matcher;
+};
+
+#endif
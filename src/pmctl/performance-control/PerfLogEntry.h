@@ -0,0 +1,39 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _PERF_LOG_ENTRY_
+#define _PERF_LOG_ENTRY_
+
+#include <string>
+#include <vector>
+using namespace std;
+
+// A parsed PmLog line, before it is kept in a PerfLogTable.
+// A missing or null PerfType/PerfGroup is stored as an empty string.
+struct PerfLogEntry
+{
+    double clock;
+    string proc;
+    string msgid;
+    string type;
+    string group;
+    string extra;   // "key:value" pairs and free text, as shown in the report
+    string raw;     // the whole line, for requiredStrings
+
+    PerfLogEntry() : clock(0.0) {}
+};
+
+#endif
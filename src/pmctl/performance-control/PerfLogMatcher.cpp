@@ -0,0 +1,267 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PerfLogMatcher.h"
+
+#include <algorithm>
+
+#include "PerfLogConfig.h"
+
+const int32_t PerfLogMatcher::ANY_VALUE;
+const int32_t PerfLogMatcher::NO_VALUE;
+const uint32_t PerfLogMatcher::EMPTY_PATTERN;
+
+PerfLogMatcher::PerfLogMatcher()
+: m_startCount(0),
+  m_hasPrefilter(false)
+{
+}
+
+int32_t PerfLogMatcher::intern(const string& value)
+{
+    unordered_map<string, int32_t>::iterator it;
+
+    if(value == "*")
+        return ANY_VALUE;
+
+    it = m_values.find(value);
+    if(it != m_values.end())
+        return it->second;
+
+    m_values.insert(make_pair(value, (int32_t) m_values.size()));
+    return m_values.size() - 1;
+}
+
+int32_t PerfLogMatcher::valueId(const string& value) const
+{
+    unordered_map<string, int32_t>::const_iterator it = m_values.find(value);
+
+    return (it == m_values.end()) ? NO_VALUE : it->second;
+}
+
+void PerfLogMatcher::addCondition(uint32_t ctx, const PerfLogCondition& cond)
+{
+    Condition compiled;
+    uint32_t id = m_conds.size();
+
+    compiled.ctx = ctx;
+    compiled.type = intern(cond.type);
+    compiled.group = intern(cond.group);
+
+    for(size_t i = 0; i < cond.requiredStrings.size(); i++)
+    {
+        const string& str = cond.requiredStrings[i];
+        unordered_map<string, uint32_t>::iterator it;
+
+        if(str.empty())
+        {
+            compiled.required.push_back(EMPTY_PATTERN);
+            continue;
+        }
+
+        it = m_patternIds.find(str);
+        if(it == m_patternIds.end())
+            it = m_patternIds.insert(make_pair(str, m_patterns.add(str))).first;
+        compiled.required.push_back(it->second);
+    }
+
+    if(cond.msgid != "*")
+        m_byMsgid[cond.msgid].push_back(id);
+    else if(compiled.type != ANY_VALUE)
+        m_byType[compiled.type].push_back(id);
+    else
+        m_byNothing.push_back(id);
+
+    m_conds.push_back(compiled);
+}
+
+// Text that any line matching the condition contains, or "" if there is none
+static string getNeedle(const PerfLogCondition& cond)
+{
+    if(cond.msgid != "*" && !cond.msgid.empty())
+        return cond.msgid;
+
+    for(size_t i = 0; i < cond.requiredStrings.size(); i++)
+    {
+        if(!cond.requiredStrings[i].empty())
+            return cond.requiredStrings[i];
+    }
+
+    if(cond.type != "*" && !cond.type.empty())
+        return cond.type;
+
+    if(cond.group != "*" && !cond.group.empty())
+        return cond.group;
+
+    return "";
+}
+
+// A line is kept if it has a PerfType and a PerfGroup, or if it matches a
+// condition. Either way it contains "PerfType" or the needle of one of the
+// conditions, so the other lines are dropped before they are parsed.
+// A condition without a needle matches anything and turns this off.
+void PerfLogMatcher::compile(const vector<PerfLogContext>& contexts)
+{
+    vector<string> needles;
+
+    *this = PerfLogMatcher();
+
+    for(size_t c = 0; c < contexts.size(); c++)
+    {
+        for(size_t j = 0; j < contexts[c].starts.size(); j++)
+            addCondition(c, contexts[c].starts[j]);
+    }
+    m_startCount = m_conds.size();
+
+    for(size_t c = 0; c < contexts.size(); c++)
+    {
+        for(size_t j = 0; j < contexts[c].ends.size(); j++)
+            addCondition(c, contexts[c].ends[j]);
+    }
+    m_patterns.build();
+
+    m_hasPrefilter = true;
+    needles.push_back("PerfType");
+    for(size_t c = 0; c < contexts.size() && m_hasPrefilter; c++)
+    {
+        const PerfLogContext& ctx = contexts[c];
+
+        for(size_t j = 0; j < ctx.starts.size() + ctx.ends.size(); j++)
+        {
+            const PerfLogCondition& cond = (j < ctx.starts.size()) ?
+                ctx.starts[j] : ctx.ends[j - ctx.starts.size()];
+            string needle = getNeedle(cond);
+
+            if(needle.empty())
+            {
+                m_hasPrefilter = false;
+                break;
+            }
+            if(find(needles.begin(), needles.end(), needle) == needles.end())
+                needles.push_back(needle);
+        }
+    }
+
+    if(m_hasPrefilter)
+    {
+        for(size_t i = 0; i < needles.size(); i++)
+            m_needles.add(needles[i]);
+        m_needles.build();
+    }
+}
+
+bool PerfLogMatcher::isCandidate(const char *line, size_t len) const
+{
+    return !m_hasPrefilter || m_needles.containsAny(line, len);
+}
+
+// The first occurrence of each string, and never before the previous one
+bool PerfLogMatcher::hasRequired(const Condition& cond, const vector<pair<uint32_t, uint32_t> >& found) const
+{
+    size_t prev = 0;
+
+    for(size_t i = 0; i < cond.required.size(); i++)
+    {
+        uint32_t pattern = cond.required[i];
+        size_t pos = 0;
+
+        if(pattern != EMPTY_PATTERN)
+        {
+            size_t j;
+
+            for(j = 0; j < found.size(); j++)
+            {
+                if(found[j].first == pattern)
+                    break;
+            }
+            if(j == found.size())
+                return false;
+            pos = found[j].second - m_patterns.length(pattern);
+        }
+
+        if(pos < prev)
+            return false;
+        prev = pos;
+    }
+    return true;
+}
+
+// Stops at the first match when ids is NULL
+bool PerfLogMatcher::scan(const PerfLogTable& table, size_t i, vector<uint32_t> *ids) const
+{
+    const vector<uint32_t> *lists[3] = { NULL, NULL, &m_byNothing };
+    vector<pair<uint32_t, uint32_t> > found;
+    bool isScanned = false;
+    int32_t type = valueId(table.type(i));
+    int32_t group = valueId(table.group(i));
+    unordered_map<string, vector<uint32_t> >::const_iterator byMsgid = m_byMsgid.find(table.msgid(i));
+    unordered_map<int32_t, vector<uint32_t> >::const_iterator byType = m_byType.find(type);
+
+    if(byMsgid != m_byMsgid.end())
+        lists[0] = &byMsgid->second;
+    if(byType != m_byType.end())
+        lists[1] = &byType->second;
+
+    for(size_t l = 0; l < 3; l++)
+    {
+        if(lists[l] == NULL)
+            continue;
+
+        for(size_t k = 0; k < lists[l]->size(); k++)
+        {
+            uint32_t id = (*lists[l])[k];
+            const Condition& cond = m_conds[id];
+
+            if(cond.type != ANY_VALUE && cond.type != type)
+                continue;
+            if(cond.group != ANY_VALUE && cond.group != group)
+                continue;
+
+            if(!cond.required.empty())
+            {
+                if(!isScanned)
+                {
+                    m_patterns.findFirst(table.raw(i), table.rawLength(i), found);
+                    isScanned = true;
+                }
+                if(!hasRequired(cond, found))
+                    continue;
+            }
+
+            if(ids == NULL)
+                return true;
+            ids->push_back(id);
+        }
+    }
+
+    if(ids == NULL)
+        return false;
+
+    sort(ids->begin(), ids->end());
+    return !ids->empty();
+}
+
+bool PerfLogMatcher::hasMatch(const PerfLogTable& table, size_t i) const
+{
+    return scan(table, i, NULL);
+}
+
+// The ids of the matching conditions, in increasing order
+void PerfLogMatcher::match(const PerfLogTable& table, size_t i, vector<uint32_t>& ids) const
+{
+    ids.clear();
+    scan(table, i, &ids);
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _PERF_LOG_MATCHER_
+#define _PERF_LOG_MATCHER_
+
+#include "AhoCorasick.h"
+#include "PerfLogTable.h"
+
+struct PerfLogCondition;
+struct PerfLogContext;
+
+// The conditions of all contexts, compiled once. A row only visits the
+// conditions filed under its msgid, under its type if the msgid is "*",
+// or under neither if both are "*". Types and groups are compared as
+// interned ids, and all requiredStrings are found in one pass over the
+// line, so the cost of a row does not grow with the number of contexts.
+//
+// Condition ids give the start conditions first, context by context,
+// then the end conditions in the same order.
+class PerfLogMatcher
+{
+public:
+    PerfLogMatcher();
+
+    void compile(const vector<PerfLogContext>& contexts);
+
+    size_t size() const { return m_conds.size(); }
+    size_t startCount() const { return m_startCount; }
+    uint32_t context(uint32_t id) const { return m_conds[id].ctx; }
+
+    bool isCandidate(const char *line, size_t len) const;
+    bool hasMatch(const PerfLogTable& table, size_t i) const;
+    void match(const PerfLogTable& table, size_t i, vector<uint32_t>& ids) const;
+
+private:
+    struct Condition
+    {
+        uint32_t ctx;
+        int32_t type;
+        int32_t group;
+        vector<uint32_t> required;
+    };
+
+    static const int32_t ANY_VALUE = -1;
+    static const int32_t NO_VALUE = -2;
+    static const uint32_t EMPTY_PATTERN = 0xffffffff;
+
+    int32_t intern(const string& value);
+    int32_t valueId(const string& value) const;
+    void addCondition(uint32_t ctx, const PerfLogCondition& cond);
+    bool scan(const PerfLogTable& table, size_t i, vector<uint32_t> *ids) const;
+    bool hasRequired(const Condition& cond, const vector<pair<uint32_t, uint32_t> >& found) const;
+
+    vector<Condition> m_conds;
+    size_t m_startCount;
+
+    unordered_map<string, int32_t> m_values;
+    unordered_map<string, uint32_t> m_patternIds;
+    AhoCorasick m_patterns;
+
+    unordered_map<string, vector<uint32_t> > m_byMsgid;
+    unordered_map<int32_t, vector<uint32_t> > m_byType;
+    vector<uint32_t> m_byNothing;
+
+    bool m_hasPrefilter;
+    AhoCorasick m_needles;
+};
+
+#endif
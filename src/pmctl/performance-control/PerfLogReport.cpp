@@ -0,0 +1,678 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PerfLogReport.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <glob.h>
+#include <sys/utsname.h>
+#include <thread>
+#include <unistd.h>
+
+#include "PmLogParser.h"
+#include "PmLogReader.h"
+#include "utils/Util.h"
+
+const string PerfLogReport::DEFAULT_PMLOG_FILE = "/var/log/messages";
+
+static const char *DEFAULT_CONFIGS[] = {
+    "./config.json",
+    "/etc/pmtrace/perf-log-viewer-conf.json"
+};
+
+// Platform information of the JSON report, as plat_info.py gets it
+struct PlatInfo
+{
+    string hwName;
+    string osName;
+    string buildInfo;
+    string codeName;
+    string modelName;
+};
+
+static string readCommand(const string& cmd)
+{
+    FILE *fp;
+    char buff[1024];
+    size_t len;
+    string out;
+
+    fp = popen(cmd.c_str(), "r");
+    if(fp == NULL)
+        return "";
+
+    while((len = fread(buff, 1, sizeof(buff), fp)) > 0)
+        out.append(buff, len);
+
+    pclose(fp);
+    return out;
+}
+
+static bool hasNyxCmd()
+{
+    return system("which nyx-cmd > /dev/null 2>&1") == 0;
+}
+
+static void getNyxInfo(const char *category, const char *key, string& value)
+{
+    JValue info = JDomParser::fromString(readCommand(string("nyx-cmd ") + category + " query --format=json 2>/dev/null"));
+
+    if(info.isObject() && info.hasKey(key) && info[key].isString())
+        value = info[key].asString();
+}
+
+static string trim(const string& str, const char *chars)
+{
+    size_t first = str.find_first_not_of(chars);
+
+    if(first == string::npos)
+        return "";
+    return str.substr(first, str.find_last_not_of(chars) - first + 1);
+}
+
+static PlatInfo getPlatInfo()
+{
+    PlatInfo plat;
+
+    if(hasNyxCmd())
+    {
+        getNyxInfo("DeviceInfo", "device_name", plat.hwName);
+        getNyxInfo("OSInfo", "webos_name", plat.osName);
+        getNyxInfo("OSInfo", "webos_build_id", plat.buildInfo);
+        getNyxInfo("OSInfo", "webos_release_codename", plat.codeName);
+        getNyxInfo("OSInfo", "webos_imagename", plat.modelName);
+    }
+    else
+    {
+        struct utsname name;
+        FILE *fp;
+        char *line = NULL;
+        size_t size = 0;
+
+        if(uname(&name) == 0)
+        {
+            plat.hwName = name.nodename;
+            plat.osName = name.sysname;
+        }
+
+        fp = fopen("/etc/os-release", "r");
+        if(fp == NULL)
+            return plat;
+
+        while(getline(&line, &size, fp) != -1)
+        {
+            string str = line;
+            size_t eq = str.find('=');
+            string key = trim(str.substr(0, eq), " \t\r\n");
+            string value = (eq == string::npos) ? "" : str.substr(eq + 1);
+
+            value = trim(trim(trim(value, "\n"), "\""), " \t\r\n");
+            if(key == "ID")
+                plat.modelName = value;
+            else if(key == "VERSION_ID")
+                plat.buildInfo = value;
+            else if(key == "PRETTY_NAME")
+                plat.codeName = value;
+        }
+
+        free(line);
+        fclose(fp);
+    }
+
+    return plat;
+}
+
+// JSON string as Python's json.dump writes it, with non-ASCII escaped
+static string jsonQuote(const string& str)
+{
+    string out = "\"";
+    char buff[16];
+
+    for(size_t i = 0; i < str.size(); )
+    {
+        unsigned char c = str[i];
+        unsigned cp;
+        int len;
+
+        if(c < 0x80)
+        {
+            i++;
+            switch(c)
+            {
+                case '"':   out += "\\\"";  break;
+                case '\\':  out += "\\\\";  break;
+                case '\n':  out += "\\n";   break;
+                case '\r':  out += "\\r";   break;
+                case '\t':  out += "\\t";   break;
+                case '\b':  out += "\\b";   break;
+                case '\f':  out += "\\f";   break;
+                default:
+                    if(c < 0x20)
+                    {
+                        snprintf(buff, sizeof(buff), "\\u%04x", c);
+                        out += buff;
+                    }
+                    else
+                        out += c;
+            }
+            continue;
+        }
+
+        if((c & 0xe0) == 0xc0)
+        {
+            cp = c & 0x1f;
+            len = 2;
+        }
+        else if((c & 0xf0) == 0xe0)
+        {
+            cp = c & 0x0f;
+            len = 3;
+        }
+        else if((c & 0xf8) == 0xf0)
+        {
+            cp = c & 0x07;
+            len = 4;
+        }
+        else
+        {
+            cp = 0xfffd;
+            len = 1;
+        }
+
+        if(len > 1)
+        {
+            if(i + len > str.size())
+            {
+                cp = 0xfffd;
+                len = 1;
+            }
+            else
+            {
+                for(int j = 1; j < len; j++)
+                    cp = (cp << 6) | (str[i + j] & 0x3f);
+            }
+        }
+        i += len;
+
+        if(cp >= 0x10000)
+        {
+            cp -= 0x10000;
+            snprintf(buff, sizeof(buff), "\\u%04x\\u%04x", 0xd800 + (cp >> 10), 0xdc00 + (cp & 0x3ff));
+        }
+        else
+            snprintf(buff, sizeof(buff), "\\u%04x", cp);
+        out += buff;
+    }
+
+    out += "\"";
+    return out;
+}
+
+// A missing value is printed the way Python prints None
+static const char *noneIfEmpty(const string& str)
+{
+    return str.empty() ? "None" : str.c_str();
+}
+
+// Value of "-x VALUE", "-xVALUE", "--name VALUE" or "--name=VALUE".
+// Returns 0 if argv[i] is another option, -1 if the value is missing.
+static int getOption(int argc, char ** argv, int& i, const char *shortOpt, const char *longOpt, string& value)
+{
+    const char *arg = argv[i];
+    size_t len;
+
+    if(shortOpt && strncmp(arg, shortOpt, 2) == 0)
+    {
+        arg += 2;
+    }
+    else if(longOpt && strncmp(arg, longOpt, (len = strlen(longOpt))) == 0 &&
+            (arg[len] == '\0' || arg[len] == '='))
+    {
+        arg += len;
+        if(*arg == '=')
+        {
+            value = arg + 1;
+            return 1;
+        }
+    }
+    else
+    {
+        return 0;
+    }
+
+    if(*arg != '\0')
+    {
+        value = arg;
+        return 1;
+    }
+    if(i + 1 >= argc)
+        return -1;
+    value = argv[++i];
+    return 1;
+}
+
+// A range of a pmlog file, and the state of the line handler while
+// a thread reads it
+struct LoadContext
+{
+    size_t file;
+    PmLogReader::Range range;
+    bool isLoaded;
+
+    const PerfLogConfig *config;
+    PerfLogTable *table;
+    PerfLogEntry entry;
+    size_t lines;
+    size_t kept;
+};
+
+// Cheap substring checks come first, most lines never get parsed
+static void handleLine(const char *line, size_t len, void *data)
+{
+    LoadContext *ctx = (LoadContext *) data;
+    PerfLogTable *table = ctx->table;
+
+    ctx->lines++;
+    if(!ctx->config->isCandidate(line, len))
+        return;
+
+    if(!PmLogParser::parse(line, len, ctx->entry))
+        return;
+
+    table->append(ctx->entry);
+    if(table->isPerfLog(table->size() - 1) || ctx->config->isInConditions(*table, table->size() - 1))
+        ctx->kept++;
+    else
+        table->pop();
+}
+
+PerfLogReport::PerfLogReport(int argc, char ** argv, bool isDebug)
+: m_argc(argc),
+  m_argv(argv),
+  m_isDebug(isDebug),
+  m_isRemote(false),
+  m_isHelp(false),
+  m_format("text")
+{
+}
+
+bool PerfLogReport::isNative() const
+{
+    struct utsname name;
+    string host;
+
+    for(int i = 2; i < m_argc; i++)
+    {
+        if(strcmp(m_argv[i], "-i") == 0 || strncmp(m_argv[i], "--ip", 4) == 0)
+            return false;
+    }
+
+    // Journal logs of the VC platform are only read by the script
+    if(!hasNyxCmd() && uname(&name) == 0)
+    {
+        host = name.nodename;
+        transform(host.begin(), host.end(), host.begin(), ::tolower);
+        if(host.find("sabreauto") != string::npos)
+            return false;
+    }
+
+    return true;
+}
+
+bool PerfLogReport::parseArgs()
+{
+    for(int i = 2; i < m_argc; i++)
+    {
+        const char *arg = m_argv[i];
+        string value;
+        int ret;
+
+        if(strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0)
+        {
+            m_isHelp = true;
+            continue;
+        }
+        if(strcmp(arg, "-d") == 0 || strcmp(arg, "--debug") == 0)
+            continue;
+
+        if((ret = getOption(m_argc, m_argv, i, "-c", "--config", value)) != 0)
+            m_configFile = value;
+        else if((ret = getOption(m_argc, m_argv, i, "-t", "--type", value)) != 0)
+            m_types.push_back(value);
+        else if((ret = getOption(m_argc, m_argv, i, "-g", "--group", value)) != 0)
+            m_groups.push_back(value);
+        else if((ret = getOption(m_argc, m_argv, i, NULL, "--format", value)) != 0)
+            m_format = value;
+        else if((ret = getOption(m_argc, m_argv, i, "-o", "--output", value)) != 0)
+            m_outputFile = value;
+        else if((ret = getOption(m_argc, m_argv, i, "-p", "--PmlogFile", value)) != 0)
+            m_pmlogFiles.push_back(value);
+        else if((ret = getOption(m_argc, m_argv, i, NULL, "--logpath", value)) != 0 ||
+                (ret = getOption(m_argc, m_argv, i, NULL, "--user", value)) != 0 ||
+                (ret = getOption(m_argc, m_argv, i, NULL, "--pw", value)) != 0 ||
+                (ret = getOption(m_argc, m_argv, i, NULL, "--port", value)) != 0)
+            ;   // accepted like the script does, they only matter with --ip
+        else
+        {
+            cerr << "[ERROR] (PerfLogReport) unrecognized argument: " << arg << endl;
+            return false;
+        }
+
+        if(ret < 0)
+        {
+            cerr << "[ERROR] (PerfLogReport) argument " << arg << ": expected one argument\n";
+            return false;
+        }
+    }
+
+    if(m_format != "text" && m_format != "csv" && m_format != "json")
+    {
+        cerr << "[ERROR] (PerfLogReport) invalid format: " << m_format << " (choose from text, csv, json)\n";
+        return false;
+    }
+
+    return true;
+}
+
+bool PerfLogReport::findConfig()
+{
+    if(!m_configFile.empty())
+        return true;
+
+    for(size_t i = 0; i < sizeof(DEFAULT_CONFIGS) / sizeof(DEFAULT_CONFIGS[0]); i++)
+    {
+        if(access(DEFAULT_CONFIGS[i], F_OK) == 0)
+        {
+            m_configFile = DEFAULT_CONFIGS[i];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// The rows of all files, sorted by clock
+bool PerfLogReport::loadLogs(PerfLogTable& table)
+{
+    vector<LoadContext> tasks;
+    vector<PerfLogTable> parts;
+    vector<thread> threads;
+    atomic<size_t> next(0);
+    size_t nthreads;
+    size_t lines = 0;
+    size_t kept = 0;
+
+    // All of the rotated logs, unless the files are given
+    if(m_pmlogFiles.empty())
+    {
+        glob_t globbuf;
+
+        if(glob((DEFAULT_PMLOG_FILE + "*").c_str(), 0, NULL, &globbuf) == 0)
+        {
+            for(size_t i = 0; i < globbuf.gl_pathc; i++)
+                m_pmlogFiles.push_back(globbuf.gl_pathv[i]);
+        }
+        globfree(&globbuf);
+
+        if(m_pmlogFiles.empty())
+        {
+            cerr << "[ERROR] (PerfLogReport) no pmlog files: " << DEFAULT_PMLOG_FILE << "*\n";
+            return false;
+        }
+    }
+
+    // Rotated logs are read in parallel, and so are the ranges of a big one
+    for(size_t i = 0; i < m_pmlogFiles.size(); i++)
+    {
+        vector<PmLogReader::Range> ranges = PmLogReader::split(m_pmlogFiles[i], PmLogReader::SPLIT_SIZE);
+
+        for(size_t j = 0; j < ranges.size(); j++)
+        {
+            LoadContext ctx;
+
+            ctx.file = i;
+            ctx.range = ranges[j];
+            ctx.isLoaded = false;
+            ctx.config = &m_config;
+            ctx.lines = 0;
+            ctx.kept = 0;
+            tasks.push_back(ctx);
+        }
+    }
+
+    parts.resize(tasks.size());
+    for(size_t t = 0; t < tasks.size(); t++)
+        tasks[t].table = &parts[t];
+
+    nthreads = min((size_t) max(thread::hardware_concurrency(), 1u), tasks.size());
+    for(size_t i = 0; i < nthreads; i++)
+    {
+        threads.push_back(thread([this, &tasks, &next]() {
+            size_t t;
+
+            while((t = next++) < tasks.size())
+            {
+                LoadContext& ctx = tasks[t];
+                PmLogReader reader(handleLine, &ctx);
+
+                ctx.isLoaded = reader.read(m_pmlogFiles[ctx.file], ctx.range);
+                if(ctx.isLoaded)
+                    ctx.table->sortByClock();
+            }
+        }));
+    }
+    for(size_t i = 0; i < threads.size(); i++)
+        threads[i].join();
+
+    // Reported per file, like a serial read would do
+    for(size_t t = 0; t < tasks.size(); t++)
+    {
+        LoadContext& ctx = tasks[t];
+
+        lines += ctx.lines;
+        kept += ctx.kept;
+        if(!ctx.isLoaded)
+        {
+            cerr << "[ERROR] Error while loading pmlog " << m_pmlogFiles[ctx.file] << endl;
+            return false;
+        }
+
+        if(t + 1 < tasks.size() && tasks[t + 1].file == ctx.file)
+            continue;
+        if(m_isDebug)
+            cout << "[DEBUG] (PerfLogReport) " << m_pmlogFiles[ctx.file] << " : " << kept << " of " << lines << " lines\n";
+        lines = 0;
+        kept = 0;
+    }
+
+    if(m_isDebug)
+        cout << "[DEBUG] (PerfLogReport) " << tasks.size() << " ranges on " << nthreads << " threads\n";
+
+    if(parts.size() == 1)
+        table = move(parts[0]);
+    else
+        table.merge(parts);
+    return true;
+}
+
+bool PerfLogReport::isFilteredOut(const PerfLogSession& session) const
+{
+    if(!m_types.empty() && find(m_types.begin(), m_types.end(), session.reprType) == m_types.end())
+    {
+        if(m_isDebug)
+            cout << "[DEBUG] (PerfLogReport) filtered out: type(" << session.reprType << ")\n";
+        return true;
+    }
+
+    if(!m_groups.empty() && find(m_groups.begin(), m_groups.end(), session.reprGroup) == m_groups.end())
+    {
+        if(m_isDebug)
+            cout << "[DEBUG] (PerfLogReport) filtered out: group(" << session.reprGroup << ")\n";
+        return true;
+    }
+
+    return false;
+}
+
+void PerfLogReport::exportText(FILE *fp, const PerfLogTable& table, const PerfLogSessions& sessions) const
+{
+    const char *fmt = (m_format == "csv") ? "%s,%s,%s,+%s,%s\n" : "%-30s %-25s %-8s +%-8s %-s\n";
+
+    for(size_t i = 0; i < sessions.size(); i++)
+    {
+        const PerfLogSession& session = sessions[i];
+        double begin = table.clock(session.first);
+        double end = table.clock(session.first + session.count - 1);
+        double prev = begin;
+
+        if(isFilteredOut(session))
+            continue;
+
+        fprintf(fp, "Type: %s\nGroup: %s\nStart time: %4.2f\n",
+                noneIfEmpty(session.reprType), noneIfEmpty(session.reprGroup), begin);
+        fprintf(fp, fmt, "Process", "MsgID", "Time(s)", "Diff(s)", "Extra");
+
+        for(size_t j = session.first; j < session.first + session.count; j++)
+        {
+            string relTime = PmLogParser::floatToString(PmLogParser::round3(table.clock(j) - begin));
+            string diff = PmLogParser::floatToString(PmLogParser::round3(table.clock(j) - prev));
+
+            prev = table.clock(j);
+            fprintf(fp, fmt, table.proc(j).c_str(), table.msgid(j).c_str(), relTime.c_str(), diff.c_str(), table.extra(j));
+        }
+
+        fprintf(fp, "Elapsed time (s) : %2.3f\n\n", end - begin);
+    }
+}
+
+// Laid out like json.dump(indent=True) of the script
+void PerfLogReport::exportJson(FILE *fp, const PerfLogTable& table, const PerfLogSessions& sessions) const
+{
+    PlatInfo plat = getPlatInfo();
+    bool isFirst = true;
+
+    fprintf(fp, "{\n \"targetDevice\": {\n");
+    fprintf(fp, "  \"HWName\": %s,\n", jsonQuote(plat.hwName).c_str());
+    fprintf(fp, "  \"OSName\": %s,\n", jsonQuote(plat.osName).c_str());
+    fprintf(fp, "  \"BuildInfo\": %s,\n", jsonQuote(plat.buildInfo).c_str());
+    fprintf(fp, "  \"CodeName\": %s,\n", jsonQuote(plat.codeName).c_str());
+    fprintf(fp, "  \"ModelName\": %s\n", jsonQuote(plat.modelName).c_str());
+    fprintf(fp, " },\n \"data\": [");
+
+    for(size_t i = 0; i < sessions.size(); i++)
+    {
+        const PerfLogSession& session = sessions[i];
+        double begin = table.clock(session.first);
+        double end = table.clock(session.first + session.count - 1);
+
+        if(isFilteredOut(session))
+            continue;
+
+        fprintf(fp, "%s\n  {\n", isFirst ? "" : ",");
+        fprintf(fp, "   \"PerfType\": %s,\n",
+                session.reprType.empty() ? "null" : jsonQuote(session.reprType).c_str());
+        fprintf(fp, "   \"PerfGroup\": %s,\n",
+                session.reprGroup.empty() ? "null" : jsonQuote(session.reprGroup).c_str());
+        fprintf(fp, "   \"PerfValue\": %s\n  }",
+                PmLogParser::floatToString(PmLogParser::round3(end - begin)).c_str());
+        isFirst = false;
+    }
+
+    fprintf(fp, isFirst ? "]\n}" : "\n ]\n}");
+}
+
+bool PerfLogReport::run()
+{
+    PerfLogTable table;
+    PerfLogSessions sessions;
+    FILE *fp = stdout;
+
+    if(!parseArgs())
+        return false;
+
+    if(m_isHelp)
+    {
+        printHelp();
+        return true;
+    }
+
+    if(!findConfig())
+    {
+        cerr << "[ERROR] Cannot find a config file\n";
+        return false;
+    }
+
+    if(!m_config.load(m_configFile))
+    {
+        cerr << "[ERROR] Failed to load a config(" << m_configFile << ")\n";
+        return false;
+    }
+
+    if(!loadLogs(table))
+        return false;
+
+    sessions = PerfLogAnalyzer(m_config, table).analyze();
+
+    if(m_isDebug)
+        cout << "[DEBUG] (PerfLogReport) entries : " << table.size() << ", sessions : " << sessions.size() << endl;
+
+    if(!m_outputFile.empty())
+    {
+        fp = fopen(m_outputFile.c_str(), "w");
+        if(fp == NULL)
+        {
+            cerr << "[ERROR] Cannot open " << m_outputFile << ": " << strerror(errno) << endl;
+            return false;
+        }
+    }
+
+    if(m_format == "json")
+        exportJson(fp, table, sessions);
+    else
+        exportText(fp, table, sessions);
+
+    if(fp != stdout)
+        fclose(fp);
+    else
+        fflush(fp);
+
+    return true;
+}
+
+void PerfLogReport::printHelp() const
+{
+    cout << "Usage: pmctl perflog-report [-h] [-c CONFIG] [-t TYPE] [-g GROUP]\n \
+                             [--format {text,csv,json}] [-o OUTPUT]\n \
+                             [-i IP] [--user USER] [--pw PW] [--port PORT]\n \
+                             [-p PMLOGFILE]\n\n";
+    cout << "Performance Log Viewer\n\n";
+    cout << "optional arguments:\n \
+ -h, --help\t\t\tshow this help message and exit\n \
+ -c, --config CONFIG\t\tLoad a config file (default: config.json or\n \
+\t\t\t\t/etc/pmtrace/perf-log-viewer-conf.json)\n \
+ -t, --type TYPE\t\tSpecify performance type to filter out\n \
+ -g, --group GROUP\t\tSpecify performance group to filter out\n \
+ --format {text,csv,json}\tSet output format\n \
+ -o, --output OUTPUT\t\tOutput file name\n \
+ -i, --ip IP\t\t\tip address to a device (runs perf_log_viewer.py)\n \
+ --user USER\t\t\tA username for connecting to a target device (default: root)\n \
+ --pw PW\t\t\tpassword for connecting to a target device\n \
+ --port PORT\t\t\tPort (default:22)\n \
+ -p, --PmlogFile PMLOGFILE\tPmLog file (default: " << DEFAULT_PMLOG_FILE << "*)\n\n";
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _PERF_LOG_REPORT_
+#define _PERF_LOG_REPORT_
+
+#include <cstdio>
+
+#include "PerfLogAnalyzer.h"
+
+// Native "pmctl perflog-report". It reads PmLog files of this device and
+// writes the same reports as perf_log_viewer.py. Remote devices (--ip)
+// and journal based platforms are still left to the script.
+class PerfLogReport
+{
+public:
+    PerfLogReport(int argc, char ** argv, bool isDebug);
+
+    bool isNative() const;
+    bool run();
+
+private:
+    bool parseArgs();
+    bool findConfig();
+    bool loadLogs(PerfLogTable& table);
+    bool isFilteredOut(const PerfLogSession& session) const;
+    void exportText(FILE *fp, const PerfLogTable& table, const PerfLogSessions& sessions) const;
+    void exportJson(FILE *fp, const PerfLogTable& table, const PerfLogSessions& sessions) const;
+    void printHelp() const;
+
+public:
+    static const string DEFAULT_PMLOG_FILE;
+
+private:
+    int m_argc;
+    char ** m_argv;
+    bool m_isDebug;
+    bool m_isRemote;
+    bool m_isHelp;
+
+    string m_configFile;
+    string m_format;
+    string m_outputFile;
+    vector<string> m_types;
+    vector<string> m_groups;
+    vector<string> m_pmlogFiles;
+
+    PerfLogConfig m_config;
+};
+
+#endif
@@ -0,0 +1,160 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PerfLogTable.h"
+
+#include <algorithm>
+#include <queue>
+
+PerfLogTable::PerfLogTable()
+{
+    intern("");
+}
+
+uint32_t PerfLogTable::intern(const string& str)
+{
+    unordered_map<string, uint32_t>::const_iterator it = m_ids.find(str);
+
+    if(it != m_ids.end())
+        return it->second;
+
+    m_strings.push_back(str);
+    m_ids[str] = m_strings.size() - 1;
+    return m_strings.size() - 1;
+}
+
+void PerfLogTable::append(const PerfLogEntry& entry)
+{
+    m_clock.push_back(entry.clock);
+    m_proc.push_back(intern(entry.proc));
+    m_msgid.push_back(intern(entry.msgid));
+    m_type.push_back(intern(entry.type));
+    m_group.push_back(intern(entry.group));
+
+    m_text.push_back(m_arena.size());
+    m_rawLength.push_back(entry.raw.size());
+    m_arena.insert(m_arena.end(), entry.raw.begin(), entry.raw.end());
+    m_arena.push_back('\0');
+    m_arena.insert(m_arena.end(), entry.extra.begin(), entry.extra.end());
+    m_arena.push_back('\0');
+}
+
+// Drops the last row. Its interned strings are kept.
+void PerfLogTable::pop()
+{
+    m_arena.resize(m_text.back());
+
+    m_clock.pop_back();
+    m_proc.pop_back();
+    m_msgid.pop_back();
+    m_type.pop_back();
+    m_group.pop_back();
+    m_text.pop_back();
+    m_rawLength.pop_back();
+}
+
+template<typename T>
+void PerfLogTable::permute(vector<T>& column, const vector<size_t>& order)
+{
+    vector<T> sorted;
+
+    sorted.reserve(column.size());
+    for(size_t i = 0; i < order.size(); i++)
+        sorted.push_back(column[order[i]]);
+    column.swap(sorted);
+}
+
+// Stable, as the rows of one clock have to stay in file order.
+// The arena doesn't move, only the offsets into it.
+void PerfLogTable::sortByClock()
+{
+    vector<size_t> order(size());
+    const vector<double>& clocks = m_clock;
+
+    for(size_t i = 0; i < order.size(); i++)
+        order[i] = i;
+
+    stable_sort(order.begin(), order.end(), [&clocks](size_t a, size_t b) {
+        return clocks[a] < clocks[b];
+    });
+
+    permute(m_clock, order);
+    permute(m_proc, order);
+    permute(m_msgid, order);
+    permute(m_type, order);
+    permute(m_group, order);
+    permute(m_text, order);
+    permute(m_rawLength, order);
+}
+
+// Replaces the rows with those of parts, each one sorted by clock. Rows
+// of one clock come in the order of parts, then in their order within a
+// part, so the result is the same as sortByClock() of all parts appended.
+void PerfLogTable::merge(const vector<PerfLogTable>& parts)
+{
+    typedef pair<double, size_t> Head;  // clock of the next row, and part
+
+    priority_queue<Head, vector<Head>, greater<Head> > heads;
+    vector<vector<uint32_t> > ids(parts.size());
+    vector<size_t> bases(parts.size());
+    vector<size_t> cursors(parts.size(), 0);
+    size_t rows = 0;
+
+    *this = PerfLogTable();
+
+    // Arenas are copied whole, the rows are picked in order below
+    for(size_t p = 0; p < parts.size(); p++)
+    {
+        const PerfLogTable& part = parts[p];
+
+        for(size_t s = 0; s < part.m_strings.size(); s++)
+            ids[p].push_back(intern(part.m_strings[s]));
+
+        bases[p] = m_arena.size();
+        m_arena.insert(m_arena.end(), part.m_arena.begin(), part.m_arena.end());
+
+        rows += part.size();
+        if(part.size() > 0)
+            heads.push(Head(part.m_clock[0], p));
+    }
+
+    m_clock.reserve(rows);
+    m_proc.reserve(rows);
+    m_msgid.reserve(rows);
+    m_type.reserve(rows);
+    m_group.reserve(rows);
+    m_text.reserve(rows);
+    m_rawLength.reserve(rows);
+
+    while(!heads.empty())
+    {
+        size_t p = heads.top().second;
+        const PerfLogTable& part = parts[p];
+        size_t i = cursors[p]++;
+
+        heads.pop();
+        if(cursors[p] < part.size())
+            heads.push(Head(part.m_clock[cursors[p]], p));
+
+        m_clock.push_back(part.m_clock[i]);
+        m_proc.push_back(ids[p][part.m_proc[i]]);
+        m_msgid.push_back(ids[p][part.m_msgid[i]]);
+        m_type.push_back(ids[p][part.m_type[i]]);
+        m_group.push_back(ids[p][part.m_group[i]]);
+        m_text.push_back(bases[p] + part.m_text[i]);
+        m_rawLength.push_back(part.m_rawLength[i]);
+    }
+}
@@ -0,0 +1,76 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _PERF_LOG_TABLE_
+#define _PERF_LOG_TABLE_
+
+#include <stdint.h>
+#include <unordered_map>
+
+#include "PerfLogEntry.h"
+
+// The kept entries, one column per field. Process, msgid, type and group
+// repeat a lot, so they are interned. The raw line and the extra text of
+// a row are stored back to back, NUL terminated, in a single arena.
+class PerfLogTable
+{
+public:
+    PerfLogTable();
+
+    size_t size() const { return m_clock.size(); }
+
+    void append(const PerfLogEntry& entry);
+    void pop();
+    void sortByClock();
+    void merge(const vector<PerfLogTable>& parts);
+
+    double clock(size_t i) const { return m_clock[i]; }
+    const string& proc(size_t i) const { return m_strings[m_proc[i]]; }
+    const string& msgid(size_t i) const { return m_strings[m_msgid[i]]; }
+    const string& type(size_t i) const { return m_strings[m_type[i]]; }
+    const string& group(size_t i) const { return m_strings[m_group[i]]; }
+    uint32_t typeId(size_t i) const { return m_type[i]; }
+    uint32_t groupId(size_t i) const { return m_group[i]; }
+    const char *raw(size_t i) const { return &m_arena[m_text[i]]; }
+    size_t rawLength(size_t i) const { return m_rawLength[i]; }
+    const char *extra(size_t i) const { return &m_arena[m_text[i] + m_rawLength[i] + 1]; }
+    const string& str(uint32_t id) const { return m_strings[id]; }
+
+    bool isPerfLog(size_t i) const { return m_type[i] != EMPTY_ID && m_group[i] != EMPTY_ID; }
+
+public:
+    static const uint32_t EMPTY_ID = 0;
+
+private:
+    uint32_t intern(const string& str);
+
+    template<typename T>
+    static void permute(vector<T>& column, const vector<size_t>& order);
+
+    vector<double> m_clock;
+    vector<uint32_t> m_proc;
+    vector<uint32_t> m_msgid;
+    vector<uint32_t> m_type;
+    vector<uint32_t> m_group;
+    vector<size_t> m_text;
+    vector<uint32_t> m_rawLength;
+
+    vector<char> m_arena;
+    vector<string> m_strings;
+    unordered_map<string, uint32_t> m_ids;
+};
+
+#endif
@@ -0,0 +1,820 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PmLogParser.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+enum JsonKind
+{
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_FLOAT,     // left as JSON text, see scanValue()
+    JSON_OTHER
+};
+
+// Nesting limit for the values of the key/value object
+static const int JSON_MAX_DEPTH = 64;
+
+// Whitespace for Python's str.strip()
+static const char SPACES[] = " \t\n\v\f\r\x1c\x1d\x1e\x1f";
+
+// Keys that are shown in their own columns, or not at all
+static const char *EXCLUDED_KEYS[] = {
+    "utc", "utc1", "monotonicSec", "loglevel", "loglevel1", "proc", "proc1",
+    "pid", "pid1", "ctx", "ctx1", "msgid", "msgid1", "freeText", "PerfType",
+    "PerfGroup", "CLOCK", "app_id"
+};
+
+static bool scanValue(const char *& p, const char *e, string& out, JsonKind& kind, bool repr, int depth);
+
+static inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r') || (c >= '\x1c' && c <= '\x1f');
+}
+
+static inline bool isJsonSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+// [A-z] of the viewer's expression, which also takes [\]^_`
+static inline bool isAz(char c)
+{
+    return c >= 'A' && c <= 'z';
+}
+
+static inline bool isWord(char c)
+{
+    return isDigit(c) || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (c & 0x80);
+}
+
+static inline const char *skipJsonSpace(const char *p, const char *e)
+{
+    while(p < e && isJsonSpace(*p))
+        p++;
+    return p;
+}
+
+static const char *skipClass(const char *p, const char *e, bool (*cls)(char))
+{
+    while(p < e && cls(*p))
+        p++;
+    return p;
+}
+
+static bool isAzOrDigit(char c)
+{
+    return isAz(c) || isDigit(c);
+}
+
+static bool isAzOrDot(char c)
+{
+    return isAz(c) || c == '.';
+}
+
+static bool isDigitOrDot(char c)
+{
+    return isDigit(c) || c == '.';
+}
+
+static bool isWordOrDot(char c)
+{
+    return isWord(c) || c == '.';
+}
+
+// One or more characters of the class, then sep
+static bool scanRun(const char *& p, const char *e, bool (*cls)(char), char sep)
+{
+    const char *s = p;
+
+    p = skipClass(s, e, cls);
+    if(p == s || p >= e || *p != sep)
+        return false;
+    p++;
+    return true;
+}
+
+// "(?P<ctx>.+?) (?P<msgid>.+?) (?P<rest>.*)$"
+static bool scanCtxMsgid(const char *p, const char *e, const char *& msgid, const char *& rest)
+{
+    const char *s, *t;
+
+    if(e - p < 2)
+        return false;
+    s = (const char *) memchr(p + 1, ' ', e - p - 1);
+    if(!s || e - s < 2)
+        return false;
+    t = (const char *) memchr(s + 2, ' ', e - s - 2);
+    if(!t)
+        return false;
+
+    msgid = s + 1;
+    rest = t + 1;
+    return true;
+}
+
+// " [PID] " at p, with any number of digits
+static const char *scanPid(const char *p, const char *e)
+{
+    if(e - p < 4 || p[0] != ' ' || p[1] != '[')
+        return NULL;
+    p = skipClass(p + 2, e, isDigit);
+    if(e - p < 2 || p[0] != ']' || p[1] != ' ')
+        return NULL;
+    return p + 2;
+}
+
+static void appendUtf8(string& out, unsigned cp)
+{
+    if(cp < 0x80)
+    {
+        out += (char) cp;
+    }
+    else if(cp < 0x800)
+    {
+        out += (char) (0xc0 | (cp >> 6));
+        out += (char) (0x80 | (cp & 0x3f));
+    }
+    else if(cp < 0x10000)
+    {
+        out += (char) (0xe0 | (cp >> 12));
+        out += (char) (0x80 | ((cp >> 6) & 0x3f));
+        out += (char) (0x80 | (cp & 0x3f));
+    }
+    else
+    {
+        out += (char) (0xf0 | (cp >> 18));
+        out += (char) (0x80 | ((cp >> 12) & 0x3f));
+        out += (char) (0x80 | ((cp >> 6) & 0x3f));
+        out += (char) (0x80 | (cp & 0x3f));
+    }
+}
+
+static bool scanHex4(const char *p, const char *e, unsigned& cp)
+{
+    if(e - p < 4)
+        return false;
+
+    cp = 0;
+    for(int i = 0; i < 4; i++)
+    {
+        char c = p[i];
+
+        cp <<= 4;
+        if(isDigit(c))
+            cp |= c - '0';
+        else if(c >= 'a' && c <= 'f')
+            cp |= c - 'a' + 10;
+        else if(c >= 'A' && c <= 'F')
+            cp |= c - 'A' + 10;
+        else
+            return false;
+    }
+    return true;
+}
+
+// Decodes the string whose opening quote is at p
+static bool scanString(const char *& p, const char *e, string& out)
+{
+    p++;
+    while(p < e)
+    {
+        const char *s = p;
+
+        while(p < e && *p != '"' && *p != '\\' && (unsigned char) *p >= 0x20)
+            p++;
+        out.append(s, p);
+        if(p >= e || (unsigned char) *p < 0x20)
+            return false;
+        if(*p++ == '"')
+            return true;
+        if(p >= e)
+            return false;
+
+        switch(*p++)
+        {
+            case '"':   out += '"';     break;
+            case '\\':  out += '\\';    break;
+            case '/':   out += '/';     break;
+            case 'b':   out += '\b';    break;
+            case 'f':   out += '\f';    break;
+            case 'n':   out += '\n';    break;
+            case 'r':   out += '\r';    break;
+            case 't':   out += '\t';    break;
+            case 'u':
+            {
+                unsigned cp, lo;
+
+                if(!scanHex4(p, e, cp))
+                    return false;
+                p += 4;
+                if(cp >= 0xd800 && cp < 0xdc00 && e - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                   scanHex4(p + 2, e, lo) && lo >= 0xdc00 && lo < 0xe000)
+                {
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                    p += 6;
+                }
+                appendUtf8(out, cp);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+// Python's repr() of a string
+static void appendRepr(string& out, const string& str)
+{
+    char quote = '\'';
+
+    if(str.find('\'') != string::npos && str.find('"') == string::npos)
+        quote = '"';
+
+    out += quote;
+    for(size_t i = 0; i < str.size(); i++)
+    {
+        unsigned char c = str[i];
+        char buf[8];
+
+        if(c == '\\' || c == (unsigned char) quote)
+        {
+            out += '\\';
+            out += c;
+        }
+        else if(c == '\t')
+            out += "\\t";
+        else if(c == '\n')
+            out += "\\n";
+        else if(c == '\r')
+            out += "\\r";
+        else if(c < 0x20 || c == 0x7f)
+        {
+            snprintf(buf, sizeof(buf), "\\x%02x", c);
+            out += buf;
+        }
+        else
+            out += c;
+    }
+    out += quote;
+}
+
+// Appends an integer the way Python prints it, and a float as it is
+static bool scanNumber(const char *& p, const char *e, string& out, bool& isFloat)
+{
+    const char *s = p;
+
+    isFloat = false;
+    if(p < e && *p == '-')
+        p++;
+    if(e - p >= 8 && memcmp(p, "Infinity", 8) == 0)
+    {
+        p += 8;
+        out.append(s, p);
+        isFloat = true;
+        return true;
+    }
+    if(p >= e || !isDigit(*p))
+        return false;
+    if(*p == '0')
+        p++;
+    else
+        p = skipClass(p, e, isDigit);
+
+    if(p < e && *p == '.')
+    {
+        if(++p >= e || !isDigit(*p))
+            return false;
+        p = skipClass(p, e, isDigit);
+        isFloat = true;
+    }
+    if(p < e && (*p == 'e' || *p == 'E'))
+    {
+        if(++p < e && (*p == '+' || *p == '-'))
+            p++;
+        if(p >= e || !isDigit(*p))
+            return false;
+        p = skipClass(p, e, isDigit);
+        isFloat = true;
+    }
+
+    if(p - s == 2 && !isFloat && s[0] == '-' && s[1] == '0')
+        out += '0';
+    else
+        out.append(s, p);
+    return true;
+}
+
+static bool scanLiteral(const char *& p, const char *e, const char *lit, const char *str, string& out)
+{
+    size_t len = strlen(lit);
+
+    if((size_t) (e - p) < len || memcmp(p, lit, len) != 0)
+        return false;
+    p += len;
+    out += str;
+    return true;
+}
+
+// Arrays and objects are printed like Python prints lists and dicts
+static bool scanContainer(const char *& p, const char *e, string& out, int depth)
+{
+    char close = (*p == '{') ? '}' : ']';
+    bool first = true;
+
+    if(depth >= JSON_MAX_DEPTH)
+        return false;
+
+    out += *p++;
+    p = skipJsonSpace(p, e);
+    if(p < e && *p == close)
+    {
+        out += *p++;
+        return true;
+    }
+
+    while(p < e)
+    {
+        JsonKind kind;
+
+        if(!first)
+            out += ", ";
+        first = false;
+
+        if(close == '}')
+        {
+            string key;
+
+            if(*p != '"' || !scanString(p, e, key))
+                return false;
+            appendRepr(out, key);
+            p = skipJsonSpace(p, e);
+            if(p >= e || *p++ != ':')
+                return false;
+            out += ": ";
+            p = skipJsonSpace(p, e);
+        }
+
+        if(!scanValue(p, e, out, kind, true, depth + 1))
+            return false;
+
+        p = skipJsonSpace(p, e);
+        if(p >= e)
+            return false;
+        if(*p == close)
+        {
+            out += *p++;
+            return true;
+        }
+        if(*p++ != ',')
+            return false;
+        p = skipJsonSpace(p, e);
+    }
+    return false;
+}
+
+// Appends Python's str() of the value at p, or its repr() inside containers.
+// Floats are only formatted inside containers. Otherwise they are left as
+// JSON text for the caller, which often only needs the number.
+static bool scanValue(const char *& p, const char *e, string& out, JsonKind& kind, bool repr, int depth)
+{
+    size_t start = out.size();
+    bool isFloat;
+
+    if(p >= e)
+        return false;
+
+    kind = JSON_OTHER;
+    switch(*p)
+    {
+        case '"':
+            kind = JSON_STRING;
+            if(repr)
+            {
+                string str;
+
+                if(!scanString(p, e, str))
+                    return false;
+                appendRepr(out, str);
+                return true;
+            }
+            return scanString(p, e, out);
+        case '{':
+        case '[':
+            return scanContainer(p, e, out, depth);
+        case 't':
+            return scanLiteral(p, e, "true", "True", out);
+        case 'f':
+            return scanLiteral(p, e, "false", "False", out);
+        case 'n':
+            return scanLiteral(p, e, "null", "None", out);
+        case 'N':
+            kind = JSON_NUMBER;
+            return scanLiteral(p, e, "NaN", "nan", out);
+        default:
+            kind = JSON_NUMBER;
+            if(!scanNumber(p, e, out, isFloat))
+                return false;
+            if(isFloat)
+            {
+                kind = JSON_FLOAT;
+                if(depth > 0)
+                {
+                    double val = strtod(out.c_str() + start, NULL);
+
+                    out.resize(start);
+                    out += PmLogParser::floatToString(val);
+                }
+            }
+            return true;
+    }
+}
+
+static bool isExcludedKey(const string& key)
+{
+    for(size_t i = 0; i < sizeof(EXCLUDED_KEYS) / sizeof(EXCLUDED_KEYS[0]); i++)
+    {
+        if(key == EXCLUDED_KEYS[i])
+            return true;
+    }
+    return false;
+}
+
+bool PmLogParser::parse(const char *line, size_t len, PerfLogEntry& entry)
+{
+    const char *b = line;
+    const char *e = line + len;
+    const char *rest;
+
+    while(b < e && isSpace(*b))
+        b++;
+    while(e > b && isSpace(e[-1]))
+        e--;
+
+    entry.clock = 0.0;
+    entry.type.clear();
+    entry.group.clear();
+    entry.extra.clear();
+
+    if(!scanPmLog(b, e, entry, rest) && !scanSyslog(b, e, entry, rest))
+        return false;
+
+    if(!scanKvs(rest, e, entry))
+        return false;
+
+    entry.raw.assign(b, e);
+    return true;
+}
+
+// UTC [MONOTONIC] LOGLEVEL PROCESS [PID] CONTEXT MSGID REST
+//
+// UTC is greedy, so the last " [MONOTONIC] " that is followed by the
+// other fields wins. PROCESS ends at the first " [PID] ".
+bool PmLogParser::scanPmLog(const char *b, const char *e, PerfLogEntry& entry, const char *& rest)
+{
+    const char *bracket = e;
+
+    while(bracket > b + 1)
+    {
+        const char *p, *monoEnd, *level, *proc, *pid, *msgid;
+        char buf[64];
+        char *end;
+        double mono;
+
+        bracket = (const char *) memrchr(b + 1, '[', bracket - b - 1);
+        if(!bracket)
+            return false;
+        if(bracket[-1] != ' ')
+            continue;
+
+        p = skipClass(bracket + 1, e, isDigitOrDot);
+        if(p == bracket + 1 || e - p < 2 || p[0] != ']' || p[1] != ' ')
+            continue;
+        monoEnd = p;
+
+        level = p + 2;
+        p = skipClass(level, e, isWordOrDot);
+        if(p == level || p >= e || *p != ' ')
+            continue;
+
+        proc = p + 1;
+        pid = NULL;
+        for(p = proc + 1; p < e; p++)
+        {
+            p = (const char *) memchr(p, ' ', e - p);
+            if(!p)
+                break;
+            if((pid = scanPid(p, e)) != NULL)
+                break;
+        }
+        if(!pid || !scanCtxMsgid(pid, e, msgid, rest))
+            continue;
+
+        // The expression has matched; a bad MONOTONIC fails the line
+        if((size_t) (monoEnd - bracket) > sizeof(buf))
+            return false;
+        memcpy(buf, bracket + 1, monoEnd - bracket - 1);
+        buf[monoEnd - bracket - 1] = '\0';
+        mono = strtod(buf, &end);
+        if(end == buf || *end != '\0')
+            return false;
+
+        entry.clock = mono;
+        entry.proc.assign(proc, p);
+        entry.msgid.assign(msgid, rest - 1);
+        return true;
+    }
+    return false;
+}
+
+// Mon DD HH:MM:SS HOST LEVEL PROCESS: [..] [LOGGER] CONTEXT MSGID REST
+//
+// The bracketed fields are greedy, so the last "] [" and "] " that
+// leave room for the other fields are taken.
+bool PmLogParser::scanSyslog(const char *b, const char *e, PerfLogEntry& entry, const char *& rest)
+{
+    const char *p = b;
+    const char *proc, *procEnd, *open, *close, *msgid;
+
+    if(!scanRun(p, e, isAz, ' ') || !scanRun(p, e, isDigit, ' ') ||
+       !scanRun(p, e, isDigit, ':') || !scanRun(p, e, isDigit, ':') ||
+       !scanRun(p, e, isDigit, ' ') || !scanRun(p, e, isAzOrDigit, ' ') ||
+       !scanRun(p, e, isAzOrDot, ' '))
+        return false;
+
+    proc = p;
+    p = skipClass(proc, e, isAz);
+    procEnd = p;
+    if(p == proc || e - p < 3 || p[0] != ':' || p[1] != ' ' || p[2] != '[')
+        return false;
+    p += 3;
+
+    for(open = e - 3; open >= p; open--)
+    {
+        if(open[0] != ']' || open[1] != ' ' || open[2] != '[')
+            continue;
+
+        for(close = e - 2; close >= open + 3; close--)
+        {
+            if(close[0] != ']' || close[1] != ' ')
+                continue;
+            if(!scanCtxMsgid(close + 2, e, msgid, rest))
+                continue;
+
+            entry.clock = 0.0;
+            entry.proc.assign(proc, procEnd);
+            entry.msgid.assign(msgid, rest - 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+// {KVS} FREETEXT
+//
+// The object ends at the brace that balances the first one. Braces are
+// counted without regard to strings, like the viewer does.
+bool PmLogParser::scanKvs(const char *b, const char *e, PerfLogEntry& entry)
+{
+    vector<pair<string, string> > pairs;
+    const char *end = NULL;
+    const char *p;
+    int depth = 0;
+    bool hasClock = false;
+    double clock = 0.0;
+
+    for(p = b; p < e; p++)
+    {
+        if(*p == '{')
+        {
+            depth++;
+        }
+        else if(*p == '}')
+        {
+            if(depth == 0)
+                return false;
+            if(--depth == 0)
+            {
+                end = p + 1;
+                break;
+            }
+        }
+    }
+    if(!end)
+        return false;
+
+    p = skipJsonSpace(b, end);
+    if(p >= end || *p++ != '{')
+        return false;
+    p = skipJsonSpace(p, end);
+
+    while(p < end && *p != '}')
+    {
+        string key;
+        string value;
+        JsonKind kind;
+
+        if(*p != '"' || !scanString(p, end, key))
+            return false;
+        p = skipJsonSpace(p, end);
+        if(p >= end || *p++ != ':')
+            return false;
+        p = skipJsonSpace(p, end);
+        if(!scanValue(p, end, value, kind, false, 0))
+            return false;
+        p = skipJsonSpace(p, end);
+        if(p < end && *p == ',')
+        {
+            p = skipJsonSpace(p + 1, end);
+            if(p >= end || *p == '}')
+                return false;
+        }
+        else if(p >= end || *p != '}')
+        {
+            return false;
+        }
+
+        if(kind == JSON_FLOAT && key != "CLOCK" && key != "monotonicSec")
+            value = floatToString(strtod(value.c_str(), NULL));
+
+        if(key == "PerfType")
+        {
+            entry.type = (kind == JSON_OTHER && value == "None") ? "" : value;
+        }
+        else if(key == "PerfGroup")
+        {
+            entry.group = (kind == JSON_OTHER && value == "None") ? "" : value;
+        }
+        else if(key == "CLOCK")
+        {
+            clock = strtod(value.c_str(), NULL);
+            hasClock = true;
+        }
+        else if(key == "monotonicSec")
+        {
+            entry.clock = strtod(value.c_str(), NULL);
+        }
+        else if(key == "proc")
+        {
+            entry.proc = value;
+        }
+        else if(key == "msgid")
+        {
+            entry.msgid = value;
+        }
+        else if(!isExcludedKey(key))
+        {
+            size_t i;
+
+            // A repeated key keeps its first position, with the last value
+            for(i = 0; i < pairs.size(); i++)
+            {
+                if(pairs[i].first == key)
+                    break;
+            }
+            if(i < pairs.size())
+                pairs[i].second = std::move(value);
+            else
+                pairs.push_back(make_pair(std::move(key), std::move(value)));
+        }
+    }
+    if(p >= end || p + 1 != end)
+        return false;
+
+    if(hasClock)
+        entry.clock = clock;
+
+    for(size_t i = 0; i < pairs.size(); i++)
+    {
+        entry.extra += pairs[i].first;
+        entry.extra += ':';
+        entry.extra += pairs[i].second;
+        entry.extra += ' ';
+    }
+
+    // Free text, then the whole thing is stripped as one
+    p = end;
+    while(p < e && isSpace(*p))
+        p++;
+    entry.extra += ' ';
+    entry.extra.append(p, e);
+    {
+        size_t first = entry.extra.find_first_not_of(SPACES);
+        size_t last = entry.extra.find_last_not_of(SPACES);
+
+        if(first == string::npos)
+            entry.extra.clear();
+        else
+            entry.extra = entry.extra.substr(first, last - first + 1);
+    }
+    return true;
+}
+
+// Python's repr() of a float: the shortest string that reads back the same
+string PmLogParser::floatToString(double val)
+{
+    char buf[40];
+    char digits[20];
+    int ndigits = 0;
+    int exp;
+    bool negative;
+    char *p;
+    string out;
+
+    if(std::isnan(val))
+        return "nan";
+    if(std::isinf(val))
+        return val < 0 ? "-inf" : "inf";
+
+    for(int prec = 1; prec <= 17; prec++)
+    {
+        snprintf(buf, sizeof(buf), "%.*e", prec - 1, val);
+        if(strtod(buf, NULL) == val)
+            break;
+    }
+
+    p = buf;
+    negative = (*p == '-');
+    if(negative)
+        p++;
+    for(; *p != 'e'; p++)
+    {
+        if(*p != '.')
+            digits[ndigits++] = *p;
+    }
+    exp = atoi(p + 1);
+    while(ndigits > 1 && digits[ndigits - 1] == '0')
+        ndigits--;
+
+    if(negative)
+        out += '-';
+
+    if(exp >= -4 && exp < 16)
+    {
+        if(exp < 0)
+        {
+            out += "0.";
+            out.append(-exp - 1, '0');
+            out.append(digits, ndigits);
+        }
+        else
+        {
+            for(int i = 0; i <= exp; i++)
+                out += (i < ndigits) ? digits[i] : '0';
+            out += '.';
+            if(ndigits > exp + 1)
+                out.append(digits + exp + 1, ndigits - exp - 1);
+            else
+                out += '0';
+        }
+    }
+    else
+    {
+        out += digits[0];
+        if(ndigits > 1)
+        {
+            out += '.';
+            out.append(digits + 1, ndigits - 1);
+        }
+        snprintf(buf, sizeof(buf), "e%c%02d", exp < 0 ? '-' : '+', exp < 0 ? -exp : exp);
+        out += buf;
+    }
+    return out;
+}
+
+// Python's round(val, 3)
+double PmLogParser::round3(double val)
+{
+    char buf[40];
+
+    // Doubles this large have no digits to drop
+    if(!std::isfinite(val) || fabs(val) >= 1e15)
+        return val;
+
+    snprintf(buf, sizeof(buf), "%.3f", val);
+    return strtod(buf, NULL);
+}
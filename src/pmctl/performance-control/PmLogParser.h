@@ -0,0 +1,44 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _PM_LOG_PARSER_
+#define _PM_LOG_PARSER_
+
+#include "PerfLogEntry.h"
+
+// Hand-written scanner for PmLog lines, replacing the regular expression
+// of perf_log_viewer.py. Two formats are accepted:
+//
+//   UTC [MONOTONIC] LOGLEVEL PROCESS [PID] CONTEXT MSGID {KVS} FREETEXT
+//   Mon DD HH:MM:SS HOST LEVEL PROCESS: [..] [LOGGER] CONTEXT MSGID {KVS} FREETEXT
+//
+// KVS must be a JSON object. Values are printed the way Python's str()
+// prints them, so that the reports match the ones of the Python viewer.
+class PmLogParser
+{
+public:
+    static bool parse(const char *line, size_t len, PerfLogEntry& entry);
+
+    static string floatToString(double val);
+    static double round3(double val);
+
+private:
+    static bool scanPmLog(const char *b, const char *e, PerfLogEntry& entry, const char *& rest);
+    static bool scanSyslog(const char *b, const char *e, PerfLogEntry& entry, const char *& rest);
+    static bool scanKvs(const char *b, const char *e, PerfLogEntry& entry);
+};
+
+#endif
@@ -0,0 +1,221 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PmLogReader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+// Small enough for the address space of 32-bit boards
+const size_t PmLogReader::MAP_WINDOW = 64 * 1024 * 1024;
+const size_t PmLogReader::GZIP_BUFFER = 256 * 1024;
+const off_t PmLogReader::SPLIT_SIZE = 32 * 1024 * 1024;
+
+PmLogReader::PmLogReader(LineHandler handler, void *data)
+: m_handler(handler),
+  m_data(data)
+{
+}
+
+bool PmLogReader::isGzip(const string& file)
+{
+    return file.size() > 3 && file.compare(file.size() - 3, 3, ".gz") == 0;
+}
+
+// Ranges of about the given size. Each one but the first begins right
+// after a newline. A ".gz" file can't be split, and neither can a file
+// that fails here; read() reports the error later.
+vector<PmLogReader::Range> PmLogReader::split(const string& file, off_t size)
+{
+    vector<Range> ranges;
+    struct stat st;
+    char buff[4096];
+    off_t begin = 0;
+    int fd;
+
+    if(isGzip(file) || (fd = open(file.c_str(), O_RDONLY)) < 0)
+    {
+        ranges.push_back(Range(0, -1));
+        return ranges;
+    }
+
+    if(fstat(fd, &st) < 0)
+        st.st_size = 0;
+
+    while(begin + size < st.st_size)
+    {
+        off_t pos = begin + size;
+        off_t next = st.st_size;
+        ssize_t len;
+
+        while((len = pread(fd, buff, sizeof(buff), pos)) > 0)
+        {
+            const char *nl = (const char *) memchr(buff, '\n', len);
+
+            if(nl)
+            {
+                next = pos + (nl - buff) + 1;
+                break;
+            }
+            pos += len;
+        }
+
+        if(next >= st.st_size)
+            break;
+        ranges.push_back(Range(begin, next - begin));
+        begin = next;
+    }
+    ranges.push_back(Range(begin, -1));
+
+    close(fd);
+    return ranges;
+}
+
+bool PmLogReader::read(const string& file, const Range& range)
+{
+    bool ret;
+
+    m_carry.clear();
+    if(isGzip(file))
+        ret = readGzip(file);
+    else
+        ret = readMapped(file, range);
+
+    if(ret)
+        finish();
+    return ret;
+}
+
+bool PmLogReader::readMapped(const string& file, const Range& range)
+{
+    off_t page = sysconf(_SC_PAGESIZE);
+    struct stat st;
+    off_t end;
+    int fd;
+
+    fd = open(file.c_str(), O_RDONLY);
+    if(fd < 0 || fstat(fd, &st) < 0)
+    {
+        cerr << "[ERROR] (PmLogReader) " << file << ": " << strerror(errno) << endl;
+        if(fd >= 0)
+            close(fd);
+        return false;
+    }
+
+    end = st.st_size;
+    if(range.second >= 0 && range.first + range.second < end)
+        end = range.first + range.second;
+
+    // mmap() takes an offset on a page boundary
+    for(off_t off = range.first; off < end; off += MAP_WINDOW)
+    {
+        size_t skip = off % page;
+        size_t len = min((off_t) MAP_WINDOW, end - off);
+        char *addr = (char *) mmap(NULL, skip + len, PROT_READ, MAP_PRIVATE, fd, off - skip);
+
+        if(addr == MAP_FAILED)
+        {
+            cerr << "[ERROR] (PmLogReader) mmap " << file << ": " << strerror(errno) << endl;
+            close(fd);
+            return false;
+        }
+
+        madvise(addr, skip + len, MADV_SEQUENTIAL);
+        feed(addr + skip, addr + skip + len);
+        munmap(addr, skip + len);
+    }
+
+    close(fd);
+    return true;
+}
+
+bool PmLogReader::readGzip(const string& file)
+{
+    vector<char> buff(GZIP_BUFFER);
+    gzFile gz;
+    int len;
+
+    gz = gzopen(file.c_str(), "rb");
+    if(gz == NULL)
+    {
+        cerr << "[ERROR] (PmLogReader) " << file << ": " << strerror(errno) << endl;
+        return false;
+    }
+    gzbuffer(gz, GZIP_BUFFER);
+
+    while((len = gzread(gz, &buff[0], buff.size())) > 0)
+        feed(&buff[0], &buff[0] + len);
+
+    if(len < 0)
+    {
+        int err;
+
+        cerr << "[ERROR] (PmLogReader) " << file << ": " << gzerror(gz, &err) << endl;
+        gzclose(gz);
+        return false;
+    }
+
+    gzclose(gz);
+    return true;
+}
+
+// Hands over the complete lines of the buffer, and keeps the last one
+// if it has no newline yet
+void PmLogReader::feed(const char *b, const char *e)
+{
+    const char *p = b;
+    const char *nl;
+
+    if(!m_carry.empty())
+    {
+        nl = (const char *) memchr(p, '\n', e - p);
+        if(!nl)
+        {
+            m_carry.append(p, e);
+            return;
+        }
+        m_carry.append(p, nl);
+        m_handler(m_carry.data(), m_carry.size(), m_data);
+        m_carry.clear();
+        p = nl + 1;
+    }
+
+    while(p < e)
+    {
+        nl = (const char *) memchr(p, '\n', e - p);
+        if(!nl)
+        {
+            m_carry.assign(p, e);
+            return;
+        }
+        m_handler(p, nl - p, m_data);
+        p = nl + 1;
+    }
+}
+
+void PmLogReader::finish()
+{
+    if(!m_carry.empty())
+        m_handler(m_carry.data(), m_carry.size(), m_data);
+    m_carry.clear();
+}
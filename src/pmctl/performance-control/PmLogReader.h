@@ -0,0 +1,63 @@
+// Copyright (c) 2026 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _PM_LOG_READER_
+#define _PM_LOG_READER_
+
+#include <string>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// Reads a PmLog file line by line, without loading it whole. Plain files
+// are mapped a window at a time, and ".gz" files are inflated as a stream.
+// The handler gets each line without its newline.
+//
+// A plain file can also be split into ranges that begin at a line, so
+// that its ranges are read by different threads.
+class PmLogReader
+{
+public:
+    typedef void (*LineHandler)(const char *line, size_t len, void *data);
+    typedef pair<off_t, off_t> Range;   // offset and length, -1 to the end
+
+    PmLogReader(LineHandler handler, void *data);
+
+    bool read(const string& file, const Range& range = Range(0, -1));
+
+    static vector<Range> split(const string& file, off_t size);
+
+private:
+    static bool isGzip(const string& file);
+
+    bool readMapped(const string& file, const Range& range);
+    bool readGzip(const string& file);
+    void feed(const char *b, const char *e);
+    void finish();
+
+public:
+    static const size_t MAP_WINDOW;
+    static const size_t GZIP_BUFFER;
+    static const off_t SPLIT_SIZE;
+
+private:
+    LineHandler m_handler;
+    void *m_data;
+    string m_carry;     // a line that continues in the next buffer
+};
+
+#endif